@@ -18,6 +18,7 @@
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
 //Game Systems
 #include "Game/Game.hpp"
+#include <math.h>
 
 App* g_theApp = nullptr;
 
@@ -64,6 +65,13 @@ void App::StartUp()
 {
 	LoadGameBlackBoard();
 
+	//Physics rate is independent of the render rate now that the render state is interpolated between ticks
+	float physicsTickRate = g_gameConfigBlackboard.GetValue("physicsTickRate", 100.f);
+	m_fixedTimeStepForUpdate = 1.0 / (double)Clamp(physicsTickRate, 30.f, 1000.f);
+	m_maxFixedStepsPerFrame = g_gameConfigBlackboard.GetValue("maxPhysicsTicksPerFrame", m_maxFixedStepsPerFrame);
+	m_usePhysicsThread = g_gameConfigBlackboard.GetValue("usePhysicsThread", m_usePhysicsThread);
+	m_overlapPhysicsWithRender = g_gameConfigBlackboard.GetValue("overlapPhysicsWithRender", m_overlapPhysicsWithRender);
+
 	g_audio = new AudioSystem();
 
 	g_eventSystem = new EventSystems();
@@ -108,6 +116,13 @@ void App::StartUp()
 
 void App::ShutDown()
 {
+	//The game holds PhysX objects (and maybe the physics thread) that have to go before PhysX does
+	m_physicsStepper.EndStep();
+	if (m_game != nullptr)
+	{
+		m_game->ShutdownSimulation();
+	}
+
 	delete g_ImGUI;
 	g_ImGUI = nullptr;
 
@@ -159,6 +174,8 @@ void App::RestartAllSystems()
 	delete g_audio;
 	g_audio = nullptr;
 
+	m_physicsStepper.EndStep();
+	m_game->ShutdownSimulation();
 	g_PxPhysXSystem->RestartPhysX();
 	
 	delete g_debugRenderer;
@@ -200,6 +217,8 @@ void App::RunFrame()
 	PostRender();
 
 	EndFrame();
+
+	BeginOverlappedPhysicsStep();
 }
 
 void App::BeginFrame()
@@ -235,22 +254,57 @@ void App::Update()
 
 	m_timeCacheForFrame += m_timeAtThisFrameBegin - m_timeAtLastFrameBegin;
 
-	if (m_minFramesToWait < 0)
+	float fixedStepAlpha = 1.f;
+	if (m_minFramesToWait < 0 && m_usePhysicsThread)
 	{
-		while (m_timeCacheForFrame > m_fixedTimeStepForUpdate)
+		//Ticks happen on the physics thread, the game works out its own alpha from the last published snapshot
+		if (!m_game->IsPhysicsThreaded())
+		{
+			m_game->StartPhysicsThread(m_fixedTimeStepForUpdate, m_maxFixedStepsPerFrame);
+		}
+
+		g_devConsole->UpdateConsole((float)(m_timeAtThisFrameBegin - m_timeAtLastFrameBegin));
+		m_timeCacheForFrame = 0.0;
+	}
+	else if (m_minFramesToWait < 0)
+	{
+		int numFixedSteps = 0;
+
+		//The step started at the end of last frame has been simulating while we rendered, collect it first
+		if (m_physicsStepper.IsStepInFlight())
+		{
+			CompletePhysicsStepInFlight();
+			numFixedSteps++;
+		}
+
+		while (m_timeCacheForFrame > m_fixedTimeStepForUpdate && numFixedSteps < m_maxFixedStepsPerFrame)
 		{
 			g_devConsole->UpdateConsole((float)m_fixedTimeStepForUpdate);
 			g_PxPhysXSystem->Update((float)m_fixedTimeStepForUpdate);
 			m_game->FixedUpdate((float)m_fixedTimeStepForUpdate);
 
 			m_timeCacheForFrame -= m_fixedTimeStepForUpdate;
+			numFixedSteps++;
+		}
+
+		//After a hitch we drop the time we couldn't simulate instead of trying to catch up, which would only make the next frame slower
+		if (m_timeCacheForFrame > m_fixedTimeStepForUpdate)
+		{
+			m_timeCacheForFrame = fmod(m_timeCacheForFrame, m_fixedTimeStepForUpdate);
 		}
+
+		fixedStepAlpha = (float)(m_timeCacheForFrame / m_fixedTimeStepForUpdate);
 	}
 	else
 	{
 		m_minFramesToWait--;
 	}
 
+	if (!m_usePhysicsThread)
+	{
+		m_game->SetFixedStepAlpha(fixedStepAlpha);
+	}
+
 	float deltaTime = static_cast<float>(m_timeAtThisFrameBegin - m_timeAtLastFrameBegin);
 
 	int timeInMS = (int)(deltaTime * 1000.f);
@@ -267,6 +321,39 @@ void App::Update()
 	m_game->Update(deltaTime);
 }
 
+void App::BeginOverlappedPhysicsStep()
+{
+	if (!m_overlapPhysicsWithRender || m_usePhysicsThread || m_minFramesToWait >= 0 || m_physicsStepper.IsStepInFlight())
+	{
+		return;
+	}
+
+	//Only start a tick we expect to be due by the next update, otherwise physics would run at the frame rate
+	double lastFrameTime = m_timeAtThisFrameBegin - m_timeAtLastFrameBegin;
+	if (m_timeCacheForFrame + lastFrameTime >= m_fixedTimeStepForUpdate)
+	{
+		m_physicsStepper.BeginStep((float)m_fixedTimeStepForUpdate);
+	}
+}
+
+void App::CompletePhysicsStepInFlight()
+{
+	if (!m_physicsStepper.IsStepInFlight())
+	{
+		return;
+	}
+
+	float deltaTime = m_physicsStepper.GetStepDeltaTime();
+	m_physicsStepper.EndStep();
+	m_game->SetPhysicsWaitTime(m_physicsStepper.GetLastWaitTimeSeconds());
+
+	g_devConsole->UpdateConsole(deltaTime);
+	m_game->FixedUpdate(deltaTime);
+
+	//Can go a little negative when the tick was started early, the next frame simply runs one tick less
+	m_timeCacheForFrame -= deltaTime;
+}
+
 void App::Render() const
 {
 	m_game->Render();	
@@ -279,6 +366,9 @@ void App::PostRender()
 
 bool App::HandleKeyPressed(unsigned char keyCode)
 {
+	//Input can reset cars, spawn objects or run console commands, so the scene can't be mid step
+	CompletePhysicsStepInFlight();
+
 	if(keyCode == TILDY_KEY)
 	{
 		g_devConsole->ToggleOpenFull();
@@ -340,6 +430,8 @@ bool App::HandleKeyPressed(unsigned char keyCode)
 
 bool App::HandleKeyReleased(unsigned char keyCode)
 {
+	CompletePhysicsStepInFlight();
+
 	switch(keyCode)
 	{
 		/*
@@ -3,6 +3,7 @@
 
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Commons/EngineCommon.hpp"
+#include "Game/PhysicsStepper.hpp"
 
 class Game;
 
@@ -36,6 +37,10 @@ private:
 	void PostRender();
 	void EndFrame();
 
+	//Overlapped stepping, the step is started after the frame ends and collected in the next update
+	void BeginOverlappedPhysicsStep();
+	void CompletePhysicsStepInFlight();
+
 public:
 	//public variables
 
@@ -57,5 +62,10 @@ private:
 	double		m_timeAtThisFrameBegin = 0;
 
 	double		m_timeCacheForFrame = 0;
-	double		m_fixedTimeStepForUpdate = 0.01;	//Making the fixed time step really small guarantees at least 1 update per frame
+	double		m_fixedTimeStepForUpdate = 0.01;	//Overridden by physicsTickRate in GameConfig.xml
+	int			m_maxFixedStepsPerFrame = 5;		//Cap on ticks per frame so a hitch can't spiral into ever longer frames
+	bool		m_usePhysicsThread = false;		//Step physics on its own thread instead of in the frame loop
+	bool		m_overlapPhysicsWithRender = false;	//Let the PhysX workers simulate while the main thread renders
+
+	PhysicsStepper	m_physicsStepper;
 };
\ No newline at end of file
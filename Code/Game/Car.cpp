@@ -3,6 +3,7 @@
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Renderer/RenderContext.hpp"
 #include "Engine/Core/VertexUtils.hpp"
+#include <math.h>
 
 //------------------------------------------------------------------------------------------------------------------------------
 Car::Car()
@@ -56,18 +57,12 @@ void Car::Update(float deltaTime, bool isInputEnabled /*= true*/)
 		m_controller->m_controlReleased = true;
 	}
 	
-	m_audio->Update();
+	m_audio->Update(GetVehicleSnapshot());
 
-	//Update the waypoint system
-	if (m_waypoints.AreLapsComplete())
-	{
-		m_raceTime = m_waypoints.GetTotalTime();
-	}
-	else
-	{
-		m_waypoints.Update(m_controller->GetVehiclePosition());
-		m_raceTime = m_waypoints.GetTotalTime();
-	}
+	//Gate checks for all cars are batched by Game::UpdateWaypointsForAllCars before this runs
+	m_waypoints.UpdateTimingSnapshot();
+	m_waypoints.PrintQueuedMessages();
+	m_raceTime = m_waypoints.GetTimingSnapshot().m_totalTime;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -146,6 +141,24 @@ Camera& Car::GetCarHUDCamera() const
 	return *m_carHUD;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Car::SetVehicleSnapshot(const VehicleStateSnapshot* snapshot)
+{
+	m_vehicleSnapshot = snapshot;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const VehicleStateSnapshot& Car::GetVehicleSnapshot() const
+{
+	if (m_vehicleSnapshot == nullptr)
+	{
+		//Not hooked up to a snapshot buffer, only safe when physics runs on this thread
+		return m_controller->GetStateSnapshot();
+	}
+
+	return *m_vehicleSnapshot;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 WaypointSystem& Car::GetWaypointsEditable()
 {
@@ -174,12 +187,18 @@ void Car::SetCameraPerspectiveProjection(float m_camFOVDegrees, float nearZ, flo
 	m_camera->SetPerspectiveProjection(m_camFOVDegrees, nearZ, farZ, aspect);
 }
 
-void Car::UpdateCarCamera(float deltaTime)
+void Car::UpdateCarCamera(float deltaTime, float fixedStepAlpha)
 {
-	Vec3 carPos = m_controller->GetVehiclePosition();
+	const VehicleStateSnapshot& snapshot = GetVehicleSnapshot();
+	if (!snapshot.m_isValid)
+	{
+		return;
+	}
+
+	Vec3 carPos = snapshot.GetInterpolatedPosition(fixedStepAlpha);
 	m_camera->SetFocalPoint(carPos);
 
-	Vec3 carForward = m_controller->GetVehicleForwardBasis();
+	Vec3 carForward = snapshot.GetInterpolatedForwardBasis(fixedStepAlpha);
 
 	m_camera->Update(carForward, deltaTime);
 }
@@ -190,6 +209,13 @@ double Car::GetRaceTime()
 	return m_raceTime;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Car::SetRacePosition(uint racePosition, uint numRacers)
+{
+	m_racePosition = racePosition;
+	m_numRacers = numRacers;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Car::RenderUIHUD() const
 {
@@ -206,6 +232,8 @@ void Car::RenderUIHUD() const
 	RenderLapCounter();
 	RenderTimeTaken();
 	RenderTimeToBeat();
+	RenderSplitDelta();
+	RenderRacePosition();
 	RenderGearIndicator();
 	RenderRevMeter();
 
@@ -262,8 +290,9 @@ void Car::RenderBackgroundBoxes() const
 void Car::RenderLapCounter() const
 {
 	//Render the current lap out of num total laps
-	int lapNumber = m_waypoints.GetCurrentLapNumber();
-	int numLaps = m_waypoints.GetMaxLapCount();
+	const RaceTimingSnapshot& timing = m_waypoints.GetTimingSnapshot();
+	int lapNumber = timing.m_lapNumber;
+	int numLaps = timing.m_maxLaps;
 
 	Vec2 camMinBounds = m_carHUD->GetOrthoBottomLeft();
 	Vec2 camMaxBounds = m_carHUD->GetOrthoTopRight();
@@ -275,7 +304,7 @@ void Car::RenderLapCounter() const
 	std::string printString = Stringf("Laps: %d/%d", lapNumber, numLaps);
 	std::vector<Vertex_PCU> textVerts;
 
-	if (!m_waypoints.AreLapsComplete())
+	if (!timing.m_lapsCompleted)
 	{
 		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::WHITE);
 	}
@@ -291,7 +320,8 @@ void Car::RenderLapCounter() const
 //------------------------------------------------------------------------------------------------------------------------------
 void Car::RenderTimeTaken() const
 {
-	float timeTaken = m_waypoints.GetTotalTime();
+	const RaceTimingSnapshot& timing = m_waypoints.GetTimingSnapshot();
+	float timeTaken = (float)timing.m_totalTime;
 
 	Vec2 camMinBounds = m_carHUD->GetOrthoBottomLeft();
 	Vec2 camMaxBounds = m_carHUD->GetOrthoTopRight();
@@ -303,7 +333,7 @@ void Car::RenderTimeTaken() const
 	std::string printString = Stringf("Time Taken: %.3f", timeTaken);
 	std::vector<Vertex_PCU> textVerts;
 
-	if (!m_waypoints.AreLapsComplete())
+	if (!timing.m_lapsCompleted)
 	{
 		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::WHITE);
 	}
@@ -319,6 +349,7 @@ void Car::RenderTimeTaken() const
 void Car::RenderTimeToBeat() const
 {
 	float timeToBeat = m_timeToBeat;
+	const RaceTimingSnapshot& timing = m_waypoints.GetTimingSnapshot();
 
 	Vec2 camMinBounds = m_carHUD->GetOrthoBottomLeft();
 	Vec2 camMaxBounds = m_carHUD->GetOrthoTopRight();
@@ -331,13 +362,13 @@ void Car::RenderTimeToBeat() const
 	std::string printString = Stringf("Time To Beat: %.3f", timeToBeat);
 	std::vector<Vertex_PCU> textVerts;
 
-	if (!m_waypoints.AreLapsComplete())
+	if (!timing.m_lapsCompleted)
 	{
 		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::WHITE);
 	}
-	else if(m_waypoints.AreLapsComplete() && m_waypoints.GetTotalTime() < m_timeToBeat)
+	else if(timing.m_lapsCompleted && timing.m_totalTime < m_timeToBeat)
 	{
-		std::string printString = Stringf("Time To Beat: %.3f", m_waypoints.GetTotalTime());
+		std::string printString = Stringf("Time To Beat: %.3f", timing.m_totalTime);
 		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::ORGANIC_GREEN);
 	}
 	else
@@ -348,10 +379,71 @@ void Car::RenderTimeToBeat() const
 	g_renderContext->DrawVertexArray(textVerts);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Car::RenderSplitDelta() const
+{
+	const RaceTimingSnapshot& timing = m_waypoints.GetTimingSnapshot();
+	if (!timing.m_hasSplitDelta)
+	{
+		//No best splits stored for this track yet
+		return;
+	}
+
+	Vec2 camMaxBounds = m_carHUD->GetOrthoTopRight();
+
+	Vec2 displayArea = camMaxBounds;
+	displayArea.x -= 90.f;
+	displayArea.y -= m_HUDFontHeight * 4.f;
+
+	std::string printString = Stringf("Split %d: %+.3f", timing.m_splitGateIndex + 1, timing.m_splitDelta);
+	std::vector<Vertex_PCU> textVerts;
+
+	if (timing.m_splitDelta <= 0.0)
+	{
+		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::ORGANIC_GREEN);
+	}
+	else
+	{
+		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::ORGANIC_RED);
+	}
+
+	g_renderContext->DrawVertexArray(textVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Car::RenderRacePosition() const
+{
+	if (m_numRacers < 2)
+	{
+		//Nothing to rank against in a solo time attack
+		return;
+	}
+
+	Vec2 camMaxBounds = m_carHUD->GetOrthoTopRight();
+
+	Vec2 displayArea = camMaxBounds;
+	displayArea.x = 20.f;
+	displayArea.y -= m_HUDFontHeight * 4.f;
+
+	std::string printString = Stringf("Pos: %u/%u", m_racePosition, m_numRacers);
+	std::vector<Vertex_PCU> textVerts;
+
+	if (m_racePosition == 1)
+	{
+		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::ORGANIC_GREEN);
+	}
+	else
+	{
+		m_HUDFont->AddVertsForText2D(textVerts, displayArea, m_HUDFontHeight, printString, Rgba::WHITE);
+	}
+
+	g_renderContext->DrawVertexArray(textVerts);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Car::RenderGearIndicator() const
 {
-	int currentGear = m_controller->GetVehicle()->mDriveDynData.getCurrentGear();
+	int currentGear = (int)GetVehicleSnapshot().m_current.m_currentGear;
 
 	Vec2 camMinBounds = m_carHUD->GetOrthoBottomLeft();
 	Vec2 camMaxBounds = m_carHUD->GetOrthoTopRight();
@@ -391,7 +483,26 @@ void Car::RenderRevMeter() const
 void Car::ResetCarPosition()
 {
 	//Vec3 vehiclePosition = m_controller->GetVehiclePosition();
-	PxTransform transform = m_controller->GetVehicle()->getRigidDynamicActor()->getGlobalPose();
+	PxRigidDynamic* vehicleActor = m_controller->GetVehicle()->getRigidDynamicActor();
+	PxTransform transform = vehicleActor->getGlobalPose();
+
+	int poseIndex = (m_respawnPoses != nullptr) ? m_respawnPoses->FindNearestPose(g_PxPhysXSystem->PxVectorToVec(transform.p)) : -1;
+	if (poseIndex != -1)
+	{
+		//Put the car back on the track facing the direction of travel. Vehicle forward is +Z so the yaw comes from the pose forward
+		const RespawnPose& pose = m_respawnPoses->GetPose((uint)poseIndex);
+		float yawRadians = atan2f(pose.m_forward.x, pose.m_forward.z);
+
+		transform.p = PhysXSystem::VecToPxVector(Vec3(pose.m_position.x, pose.m_position.y + m_resetHeight, pose.m_position.z));
+		transform.q = PxQuat(yawRadians, PxVec3(0.f, 1.f, 0.f));
+
+		vehicleActor->setLinearVelocity(PxVec3(0.f, 0.f, 0.f));
+		vehicleActor->setAngularVelocity(PxVec3(0.f, 0.f, 0.f));
+
+		m_controller->SetVehicleTransform(transform);
+		m_waypoints.ResetSweepOrigin();
+		return;
+	}
 
 	Matrix44 vehicleMatrix = PhysXSystem::MakeMatrixFromQuaternion(transform.q, transform.p);
 
@@ -407,6 +518,7 @@ void Car::ResetCarPosition()
 	transform.p = PhysXSystem::VecToPxVector(position);
 
 	m_controller->SetVehicleTransform(transform);
+	m_waypoints.ResetSweepOrigin();
 
 // 	Vec3 vehicleForward = m_controller->GetVehicleForwardBasis();
 // 
@@ -426,6 +538,12 @@ void Car::ResetCarPosition()
 // 	m_controller->SetVehicleTransform(vehiclePosition, q);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Car::SetRespawnPoses(const TrackRespawnPoses* respawnPoses)
+{
+	m_respawnPoses = respawnPoses;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Car::ResetWaypointSystem()
 {
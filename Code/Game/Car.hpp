@@ -3,6 +3,7 @@
 #include "Game/CarCamera.hpp"
 #include "Game/CarAudio.hpp"
 #include "Game/WaypointSystem.hpp"
+#include "Game/TrackRespawnPoses.hpp"
 //Engine Systems
 #include "Engine/Renderer/BitmapFont.hpp"
 
@@ -45,20 +46,26 @@ public:
 	PxRigidDynamic*				GetCarRigidbody() const;
 	Camera&						GetCarHUDCamera() const;
 
+	//The published copy of this car's physics state. Render, audio, camera and HUD only read from this
+	void						SetVehicleSnapshot(const VehicleStateSnapshot* snapshot);
+	const VehicleStateSnapshot&	GetVehicleSnapshot() const;
+
 	WaypointSystem&				GetWaypointsEditable();
 	const WaypointSystem&		GetWaypoints() const;
 
 	void						SetupNewPlaybackIDs();
 
-	//For reset car transform we will just orient it at current forward direction and set position at current pos and y += 10;
+	//Snaps the car upright onto the nearest respawn pose on the track. Without respawn poses we just lift the car in place
 	void						ResetCarPosition();
+	void						SetRespawnPoses(const TrackRespawnPoses* respawnPoses);
 	void						ResetWaypointSystem();
 
 	void						SetCameraColorTarget(ColorTargetView* colorTargetView);
 	void						SetCameraPerspectiveProjection(float m_camFOVDegrees, float nearZ, float farZ, float aspect);
-	void						UpdateCarCamera(float deltaTime);
+	void						UpdateCarCamera(float deltaTime, float fixedStepAlpha);
 
 	double						GetRaceTime();
+	void						SetRacePosition(uint racePosition, uint numRacers);
 
 	void						RenderUIHUD() const;
 private:
@@ -67,6 +74,8 @@ private:
 	void						RenderLapCounter() const;
 	void						RenderTimeTaken() const;
 	void						RenderTimeToBeat() const;
+	void						RenderSplitDelta() const;
+	void						RenderRacePosition() const;
 	void						RenderGearIndicator() const;
 	void						RenderRevMeter() const;
 
@@ -77,6 +86,8 @@ private:
 	Camera*						m_carHUD = nullptr;
 
 	WaypointSystem				m_waypoints;
+	const TrackRespawnPoses*	m_respawnPoses = nullptr;
+	const VehicleStateSnapshot*	m_vehicleSnapshot = nullptr;
 
 	const std::string			m_BASE_AUDIO_PATH = "Data/Audio/Ferrari944";
 
@@ -95,4 +106,7 @@ private:
 	float						m_resetHeight = 2.0f;
 
 	double						m_timeToBeat = 0.0;
+
+	uint						m_racePosition = 1;
+	uint						m_numRacers = 1;
 };
\ No newline at end of file
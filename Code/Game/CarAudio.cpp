@@ -49,10 +49,15 @@ void CarAudio::Startup()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarAudio::Update()
+void CarAudio::Update(const VehicleStateSnapshot& snapshot)
 {
-	UpdateSimplexMultiTrack();
-	//UpdateSimplex();
+	if (!snapshot.m_isValid)
+	{
+		return;
+	}
+
+	UpdateSimplexMultiTrack(snapshot.m_current);
+	//UpdateSimplex(snapshot.m_current);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -143,18 +148,18 @@ void CarAudio::StartupSimplex()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarAudio::UpdateRPMBased()
+void CarAudio::UpdateRPMBased(const VehicleState& state)
 {
 	//Get the car's RPM
 
-	float omega = m_carControllerRef->GetVehicle()->mDriveSimData.getEngineData().mMaxOmega;
-	float currentSpeed = m_carControllerRef->GetVehicle()->mDriveDynData.getEngineRotationSpeed();
+	float omega = state.m_maxEngineRotationSpeed;
+	float currentSpeed = state.m_engineRotationSpeed;
 
-	float radiansPerSecond = m_carControllerRef->GetVehicle()->mDriveDynData.getEngineRotationSpeed() * 60 * 0.5f / PxPi;
-	float maxRadsPerSecond = m_carControllerRef->GetVehicle()->mDriveSimData.getEngineData().mMaxOmega * 60 * 0.5f / PxPi;
+	float radiansPerSecond = state.m_engineRotationSpeed * 60 * 0.5f / PxPi;
+	float maxRadsPerSecond = state.m_maxEngineRotationSpeed * 60 * 0.5f / PxPi;
 	float RPM = PhysXSystem::GetRadiansPerSecondToRotationsPerMinute(radiansPerSecond) * (1000.f / maxRadsPerSecond);
 	float audioRatio = currentSpeed / currentSpeed * 1000.f;
-	RPM = RPM * m_carControllerRef->GetVehicle()->mDriveDynData.getCurrentGear();
+	RPM = RPM * state.m_currentGear;
 
 	for (int audioIndex = 0; audioIndex < 14; audioIndex++)
 	{
@@ -196,36 +201,21 @@ void CarAudio::UpdateRPMBased()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarAudio::UpdateGearRatioBased()
+void CarAudio::UpdateGearRatioBased(const VehicleState& state)
 {
-	PxVehicleDrive4W* vehicleRef = m_carControllerRef->GetVehicle();
-	PxVehicleGearsData gearData = vehicleRef->mDriveSimData.getGearsData();
-	int numRatios = gearData.mNbRatios;
-
 	//float timeSinceLastSwitch = vehicleRef->mDriveDynData.mGearSwitchTime;
 
-	for (int i = 0; i < numRatios; i++)
+	if (state.m_currentGear >= PxVehicleGearsData::eNEUTRAL)
 	{
-		if (vehicleRef->mDriveDynData.getCurrentGear() < PxVehicleGearsData::eNEUTRAL)
-		{
-			break;
-		}
-
 		float gearMinValue = 0.f;
-		float gearMaxValue = 0.f;
+		float gearMaxValue = state.m_currentGearRatio;
 
-		if (vehicleRef->mDriveDynData.getCurrentGear() == PxVehicleGearsData::eFIRST)
-		{
-			gearMinValue = 0.f;
-			gearMaxValue = gearData.mRatios[(int)vehicleRef->mDriveDynData.getCurrentGear()] * gearData.mFinalRatio;
-		}
-		else
+		if (state.m_currentGear != PxVehicleGearsData::eFIRST)
 		{
-			gearMinValue = gearData.mRatios[(int)vehicleRef->mDriveDynData.getCurrentGear() - 1] * gearData.mFinalRatio;
-			gearMaxValue = gearData.mRatios[(int)vehicleRef->mDriveDynData.getCurrentGear()] * gearData.mFinalRatio;
+			gearMinValue = state.m_lowerGearRatio;
 		}
 
-		float engineSpeed = vehicleRef->mDriveDynData.getEngineRotationSpeed();
+		float engineSpeed = state.m_engineRotationSpeed;
 		float enginePitch = (engineSpeed - gearMinValue) / (gearMaxValue - gearMinValue);
 		g_audio->SetSoundPlaybackSpeed(m_tempPlaybackID, enginePitch);
 		//DebuggerPrintf("\n Engine Speed: %f", engineSpeed);	//Upto around 1000
@@ -237,13 +227,13 @@ void CarAudio::UpdateGearRatioBased()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarAudio::UpdateSimplex()
+void CarAudio::UpdateSimplex(const VehicleState& state)
 {
-	float omega = m_carControllerRef->GetVehicle()->mDriveSimData.getEngineData().mMaxOmega;
-	float currentSpeed = m_carControllerRef->GetVehicle()->mDriveDynData.getEngineRotationSpeed();
+	float omega = state.m_maxEngineRotationSpeed;
+	float currentSpeed = state.m_engineRotationSpeed;
 
 	float ratio = currentSpeed / omega;
-	uint currentGear = m_carControllerRef->GetVehicle()->mDriveDynData.getCurrentGear();
+	uint currentGear = state.m_currentGear;
 
 	if (currentGear != 1)
 	{
@@ -255,7 +245,7 @@ void CarAudio::UpdateSimplex()
 		g_audio->SetSoundPlaybackVolume(m_shiftPlaybackID, 0.1f);
 	}
 
-	if (currentGear != m_carControllerRef->GetVehicle()->mDriveDynData.getTargetGear() && !m_playedShift)	
+	if (currentGear != state.m_targetGear && !m_playedShift)	
 	{
 		m_playedShift = true;
 		//Play shift sound once
@@ -266,13 +256,13 @@ void CarAudio::UpdateSimplex()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarAudio::UpdateSimplexMultiTrack()
+void CarAudio::UpdateSimplexMultiTrack(const VehicleState& state)
 {
-	float omega = m_carControllerRef->GetVehicle()->mDriveSimData.getEngineData().mMaxOmega;
-	float currentSpeed = m_carControllerRef->GetVehicle()->mDriveDynData.getEngineRotationSpeed();
+	float omega = state.m_maxEngineRotationSpeed;
+	float currentSpeed = state.m_engineRotationSpeed;
 
 	float ratio = currentSpeed / omega;
-	uint currentGear = m_carControllerRef->GetVehicle()->mDriveDynData.getCurrentGear();
+	uint currentGear = state.m_currentGear;
 
 	for (int i = 0; i < m_numFiles; i++)
 	{
@@ -297,7 +287,7 @@ void CarAudio::UpdateSimplexMultiTrack()
 				}
 			}
 		}
-		else if(m_carControllerRef->IsControlReleased() || m_carControllerRef->GetVehicle()->getRigidDynamicActor()->getLinearVelocity().magnitudeSquared() < 3.f)
+		else if(m_carControllerRef->IsControlReleased() || state.m_forwardSpeed * state.m_forwardSpeed < 3.f)
 		{
 			for (int j = 0; j < m_numFiles; j++)
 			{
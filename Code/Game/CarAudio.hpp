@@ -2,6 +2,7 @@
 
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Game/CarController.hpp"
+#include "Game/VehicleStateSnapshot.hpp"
 
 class CarAudio
 {
@@ -14,7 +15,8 @@ public:
 
 	void			Startup();
 
-	void			Update();
+	//Only reads the published vehicle snapshot, never the PhysX vehicle, so it is safe while physics is stepping on another thread
+	void			Update(const VehicleStateSnapshot& snapshot);
 
 	//Get Methods
 	const SoundID&			GetSimplexSoundID() const;
@@ -34,10 +36,10 @@ private:
 
 	void			StartupSimplex();
 
-	void			UpdateRPMBased();
-	void			UpdateGearRatioBased();
-	void			UpdateSimplex();
-	void			UpdateSimplexMultiTrack();
+	void			UpdateRPMBased(const VehicleState& state);
+	void			UpdateGearRatioBased(const VehicleState& state);
+	void			UpdateSimplex(const VehicleState& state);
+	void			UpdateSimplexMultiTrack(const VehicleState& state);
 
 private:
 	SoundID			m_carSoundIDs[16];
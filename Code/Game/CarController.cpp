@@ -110,7 +110,7 @@ void CarController::Update(float deltaTime)
 //------------------------------------------------------------------------------------------------------------------------------
 void CarController::FixedUpdate(float deltaTime)
 {
-	VehiclePhysicsUpdate(deltaTime);
+	ApplyVehicleInputs(deltaTime);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -170,13 +170,8 @@ void CarController::UpdateInputs()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarController::VehiclePhysicsUpdate(float deltaTime)
+void CarController::ApplyVehicleInputs(float deltaTime)
 {
-	VehicleSceneQueryData* vehicleSceneQueryData = g_PxPhysXSystem->GetVehicleSceneQueryData();
-	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
-	PxBatchQuery* batchQuery = g_PxPhysXSystem->GetPhysXBatchQuery();
-	PxVehicleDrivableSurfaceToTireFrictionPairs* tireFrictionPairs = g_PxPhysXSystem->GetVehicleTireFrictionPairs();
-
 	PxVehicleDrive4W* vehicle4W = GetVehicle();
 	PxVehicleDrive4WRawInputData* vehicleInputData = GetVehicleInputData();
 
@@ -195,21 +190,7 @@ void CarController::VehiclePhysicsUpdate(float deltaTime)
 		PxVehicleDrive4WSmoothAnalogRawInputsAndSetAnalogInputs(m_padSmoothingData, m_SteerVsForwardSpeedTable, *vehicleInputData, deltaTime, m_isVehicleInAir, *vehicle4W);
 	}
 
-	//Raycasts.
-	PxVehicleWheels* vehicleWheels[6] = { vehicle4W };
-	PxRaycastQueryResult* raycastResults = vehicleSceneQueryData->getRaycastQueryResultBuffer(0);
-	const PxU32 raycastResultsSize = vehicleSceneQueryData->getQueryResultBufferSize();
-	PxVehicleSuspensionRaycasts(batchQuery, 1, vehicleWheels, raycastResultsSize, raycastResults);
-
-	//Vehicle update.
-	const PxVec3 grav = scene->getGravity();
-	PxWheelQueryResult wheelQueryResults[PX_MAX_NB_WHEELS];
-	PxVehicleWheelQueryResult vehicleQueryResults[1] = { {wheelQueryResults, vehicle4W->mWheelsSimData.getNbWheels()} };
-	int numVehicles = 1;
-	PxVehicleUpdates(deltaTime, grav, *tireFrictionPairs, numVehicles, vehicleWheels, vehicleQueryResults);
-
-	//Work out if the vehicle is in the air.
-	//m_isVehicleInAir = vehicle4W->getRigidDynamicActor()->isSleeping() ? false : PxVehicleIsInAir(vehicleQueryResults[0]);
+	//m_isVehicleInAir comes from the last vehicle update's wheel queries, see RecordWheelContacts
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -228,6 +209,7 @@ void CarController::SetVehiclePosition(const Vec3& targetPosition)
 	pxTransform.q = m_vehicle4W->getRigidDynamicActor()->getGlobalPose().q;
 	
 	m_vehicle4W->getRigidDynamicActor()->setGlobalPose(pxTransform);
+	ResetStateHistory();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -240,12 +222,14 @@ void CarController::SetVehicleTransform(const Vec3& targetPosition, const PxQuat
 	pxTransform.q = quaternion;
 
 	m_vehicle4W->getRigidDynamicActor()->setGlobalPose(pxTransform);
+	ResetStateHistory();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void CarController::SetVehicleTransform(const PxTransform& transform)
 {
 	m_vehicle4W->getRigidDynamicActor()->setGlobalPose(transform);
+	ResetStateHistory();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -255,6 +239,51 @@ void CarController::SetNewPxVehicle(PxVehicleDrive4W* vehicle)
 	m_vehicle4W = vehicle;
 	m_vehicle4W->getRigidDynamicActor()->clearForce();
 	m_vehicle4W->getRigidDynamicActor()->clearTorque();
+	ResetStateHistory();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarController::ReplacePxVehicle(PxVehicleDrive4W* vehicle)
+{
+	PxRigidDynamic* oldActor = m_vehicle4W->getRigidDynamicActor();
+	PxTransform pose = oldActor->getGlobalPose();
+	PxVec3 linearVelocity = oldActor->getLinearVelocity();
+	PxVec3 angularVelocity = oldActor->getAngularVelocity();
+
+	PxU32 currentGear = m_vehicle4W->mDriveDynData.getCurrentGear();
+	PxU32 targetGear = m_vehicle4W->mDriveDynData.getTargetGear();
+	PxReal engineRotationSpeed = m_vehicle4W->mDriveDynData.getEngineRotationSpeed();
+
+	PxU32 numWheels = m_vehicle4W->mWheelsSimData.getNbWheels();
+	PxReal wheelRotationSpeeds[PX_MAX_NB_WHEELS];
+	PxReal wheelRotationAngles[PX_MAX_NB_WHEELS];
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; wheelIndex++)
+	{
+		wheelRotationSpeeds[wheelIndex] = m_vehicle4W->mWheelsDynData.getWheelRotationSpeed(wheelIndex);
+		wheelRotationAngles[wheelIndex] = m_vehicle4W->mWheelsDynData.getWheelRotationAngle(wheelIndex);
+	}
+
+	RemoveVehicleFromScene();
+	SetNewPxVehicle(vehicle);
+
+	PxRigidDynamic* actor = m_vehicle4W->getRigidDynamicActor();
+	actor->setGlobalPose(pose);
+	actor->setLinearVelocity(linearVelocity);
+	actor->setAngularVelocity(angularVelocity);
+
+	m_vehicle4W->mDriveDynData.setCurrentGear(currentGear);
+	m_vehicle4W->mDriveDynData.setTargetGear(targetGear);
+	m_vehicle4W->mDriveDynData.setEngineRotationSpeed(engineRotationSpeed);
+
+	numWheels = PxMin(numWheels, m_vehicle4W->mWheelsSimData.getNbWheels());
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; wheelIndex++)
+	{
+		m_vehicle4W->mWheelsDynData.setWheelRotationSpeed(wheelIndex, wheelRotationSpeeds[wheelIndex]);
+		m_vehicle4W->mWheelsDynData.setWheelRotationAngle(wheelIndex, wheelRotationAngles[wheelIndex]);
+	}
+
+	//Pose changed after SetNewPxVehicle reset the history, so start it again from where the car actually is
+	ResetStateHistory();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -297,6 +326,172 @@ Vec3 CarController::GetVehicleRightBasis() const
 	return right;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void CarController::RecordPhysicsState(const PxVehicleWheelQueryResult* vehicleQueryResult, float deltaTime)
+{
+	if (m_vehicle4W == nullptr)
+	{
+		return;
+	}
+
+	PxRigidDynamic* actor = m_vehicle4W->getRigidDynamicActor();
+
+	m_stateSnapshot.m_previous = m_stateSnapshot.m_current;
+	VehicleState& state = m_stateSnapshot.m_current;
+
+	state.m_actorPose = actor->getGlobalPose();
+
+	//Wheel local poses carry the spin, steer and suspension travel set by the vehicle update
+	PxShape* shapes[MAX_INTERPOLATED_SHAPES] = { nullptr };
+	int numShapes = (int)actor->getShapes(shapes, MAX_INTERPOLATED_SHAPES);
+	state.m_chassisShapeIndex = -1;
+	for (int shapeIndex = 0; shapeIndex < numShapes; shapeIndex++)
+	{
+		state.m_shapePoses[shapeIndex] = shapes[shapeIndex]->getLocalPose();
+		state.m_shapeWheelIndices[shapeIndex] = -1;
+
+		//The chassis is the only box shaped convex (8 verts), everything else is a wheel
+		PxConvexMeshGeometry geometry;
+		if (shapes[shapeIndex]->getConvexMeshGeometry(geometry) && geometry.convexMesh->getNbVertices() == 8)
+		{
+			state.m_chassisShapeIndex = shapeIndex;
+		}
+	}
+	state.m_numShapes = numShapes;
+
+	const PxVehicleWheelsSimData& wheelsSimData = m_vehicle4W->mWheelsSimData;
+	for (PxU32 wheelIndex = 0; wheelIndex < wheelsSimData.getNbWheels(); wheelIndex++)
+	{
+		PxI32 shapeIndex = wheelsSimData.getWheelShapeMapping(wheelIndex);
+		if (shapeIndex >= 0 && shapeIndex < numShapes)
+		{
+			state.m_shapeWheelIndices[shapeIndex] = (int)wheelIndex;
+		}
+	}
+
+	RecordWheelSpin(state, deltaTime);
+
+	//Engine and gearbox state for the audio and HUD
+	const PxVehicleGearsData& gearsData = m_vehicle4W->mDriveSimData.getGearsData();
+	state.m_engineRotationSpeed = m_vehicle4W->mDriveDynData.getEngineRotationSpeed();
+	state.m_maxEngineRotationSpeed = m_vehicle4W->mDriveSimData.getEngineData().mMaxOmega;
+	state.m_currentGear = m_vehicle4W->mDriveDynData.getCurrentGear();
+	state.m_targetGear = m_vehicle4W->mDriveDynData.getTargetGear();
+	state.m_currentGearRatio = gearsData.mRatios[state.m_currentGear] * gearsData.mFinalRatio;
+	state.m_lowerGearRatio = (state.m_currentGear > 0) ? gearsData.mRatios[state.m_currentGear - 1] * gearsData.mFinalRatio : 0.f;
+	state.m_forwardSpeed = m_vehicle4W->computeForwardSpeed();
+
+	if (vehicleQueryResult != nullptr)
+	{
+		RecordWheelContacts(state, *vehicleQueryResult);
+	}
+
+	if (!m_stateSnapshot.m_isValid || numShapes != m_stateSnapshot.m_previous.m_numShapes)
+	{
+		//Nothing sensible to blend from, hold the current state for this tick
+		for (int wheelIndex = 0; wheelIndex < MAX_SNAPSHOT_WHEELS; wheelIndex++)
+		{
+			state.m_wheelSpinDeltas[wheelIndex] = 0.f;
+		}
+		m_stateSnapshot.m_previous = state;
+	}
+
+	m_stateSnapshot.m_isValid = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarController::RecordWheelContacts(VehicleState& state, const PxVehicleWheelQueryResult& vehicleQueryResult)
+{
+	const PxVehicleWheelsSimData& wheelsSimData = m_vehicle4W->mWheelsSimData;
+	int numWheels = PxMin((int)vehicleQueryResult.nbWheelQueryResults, MAX_SNAPSHOT_WHEELS);
+
+	for (int wheelIndex = 0; wheelIndex < numWheels; wheelIndex++)
+	{
+		const PxWheelQueryResult& wheelResult = vehicleQueryResult.wheelQueryResults[wheelIndex];
+		WheelContactState& wheelState = state.m_wheels[wheelIndex];
+
+		wheelState.m_isInContact = !wheelResult.isInAir;
+		wheelState.m_contactPoint = wheelResult.tireContactPoint;
+		wheelState.m_contactNormal = wheelResult.tireContactNormal;
+		wheelState.m_tireFriction = wheelResult.tireFriction;
+		wheelState.m_longitudinalSlip = wheelResult.longitudinalSlip;
+		wheelState.m_lateralSlip = wheelResult.lateralSlip;
+		wheelState.m_suspensionJounce = wheelResult.suspJounce;
+		wheelState.m_suspensionForce = wheelResult.suspSpringForce;
+
+		//The surface type is the row in the tire friction table, which is the surface index for our table and road for the engine's
+		PxU32 surfaceType = wheelResult.tireSurfaceType;
+		wheelState.m_tireSurface = (surfaceType < NUM_TIRE_SURFACES) ? (eTireSurface)surfaceType : TIRE_SURFACE_ROAD;
+
+		const PxVehicleSuspensionData& suspensionData = wheelsSimData.getSuspensionData((PxU32)wheelIndex);
+		float suspensionTravel = suspensionData.mMaxCompression + suspensionData.mMaxDroop;
+		wheelState.m_suspensionCompression = (suspensionTravel > 0.f) ? PxClamp((wheelResult.suspJounce + suspensionData.mMaxDroop) / suspensionTravel, 0.f, 1.f) : 0.f;
+	}
+	state.m_numWheels = numWheels;
+
+	//A sleeping vehicle is sitting on something, its query results are left over from before it fell asleep
+	m_isVehicleInAir = m_vehicle4W->getRigidDynamicActor()->isSleeping() ? false : PxVehicleIsInAir(vehicleQueryResult);
+	state.m_isInAir = m_isVehicleInAir;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarController::RecordWheelSpin(VehicleState& state, float deltaTime)
+{
+	const PxVehicleWheelsDynData& wheelsDynData = m_vehicle4W->mWheelsDynData;
+	int numWheels = PxMin((int)m_vehicle4W->mWheelsSimData.getNbWheels(), MAX_SNAPSHOT_WHEELS);
+	const VehicleState& previousState = m_stateSnapshot.m_previous;
+
+	for (int wheelIndex = 0; wheelIndex < numWheels; wheelIndex++)
+	{
+		float spinAngle = wheelsDynData.getWheelRotationAngle((PxU32)wheelIndex);
+		state.m_wheelSpinAngles[wheelIndex] = spinAngle;
+		state.m_wheelSpinDeltas[wheelIndex] = 0.f;
+
+		if (!m_stateSnapshot.m_isValid || deltaTime <= 0.f)
+		{
+			continue;
+		}
+
+		//Whole turns don't show up in the angle difference, and PhysX snaps the angle back towards 0 every few turns. Pick the
+		//number of turns that best matches how fast the wheel was spinning
+		float expectedDelta = wheelsDynData.getWheelRotationSpeed((PxU32)wheelIndex) * deltaTime;
+		float spinDelta = spinAngle - previousState.m_wheelSpinAngles[wheelIndex];
+		float numTurns = PxFloor((expectedDelta - spinDelta) / PxTwoPi + 0.5f);
+		state.m_wheelSpinDeltas[wheelIndex] = spinDelta + numTurns * PxTwoPi;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarController::ResetStateHistory()
+{
+	m_stateSnapshot.m_isValid = false;
+	RecordPhysicsState();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const VehicleStateSnapshot& CarController::GetStateSnapshot() const
+{
+	return m_stateSnapshot;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const WheelContactState& CarController::GetWheelContactState(int wheelIndex) const
+{
+	return m_stateSnapshot.m_current.m_wheels[wheelIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int CarController::GetNumWheelContactStates() const
+{
+	return m_stateSnapshot.m_current.m_numWheels;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool CarController::IsVehicleInAir() const
+{
+	return m_isVehicleInAir;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void CarController::AccelerateForward(float analogAcc)
 {
@@ -422,5 +617,6 @@ void CarController::SetVehicleDefaultOrientation()
 	pose.q = PxQuat(0.f, 0.f, 0.f, 1.f);
 
 	m_vehicle4W->getRigidDynamicActor()->setGlobalPose(pose);
+	ResetStateHistory();
 }
 
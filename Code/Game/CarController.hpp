@@ -1,5 +1,7 @@
 #pragma once
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/VehicleStateSnapshot.hpp"
 
 class CarController
 {
@@ -18,7 +20,8 @@ public:
 	void						Update(float deltaTime);
 	void						FixedUpdate(float deltaTime);
 	void						UpdateInputs();
-	void						VehiclePhysicsUpdate(float deltaTime);
+	//Only applies the smoothed inputs, the raycasts and vehicle update are batched for every car in the VehicleManager
+	void						ApplyVehicleInputs(float deltaTime);
 								
 	void						SetControllerIDToUse(int controllerID);
 
@@ -28,6 +31,8 @@ public:
 	void						SetVehicleTransform(const Vec3& targetPosition, const PxQuat& quaternion);
 	void						SetVehicleTransform(const PxTransform& transform);
 	void						SetNewPxVehicle(PxVehicleDrive4W* vehicle);
+	//Swaps the current vehicle for a rebuilt one and carries over pose, velocities, gear, engine and wheel speeds
+	void						ReplacePxVehicle(PxVehicleDrive4W* vehicle);
 
 	//Vehicle Getters
 	PxVehicleDrive4W*			GetVehicle() const;
@@ -36,6 +41,18 @@ public:
 	Vec3						GetVehicleForwardBasis() const;
 	Vec3						GetVehicleRightBasis() const;
 
+	//RecordPhysicsState is called at the end of every fixed tick on whichever thread steps physics. The snapshot is what gets
+	//published for render, audio and the HUD. Teleporting the vehicle resets the history so it doesn't smear across.
+	//Without query results the wheel contacts from the last vehicle update are kept. The tick length is only used to work out
+	//how far each wheel spun, 0 means there is no tick to blend across
+	void						RecordPhysicsState(const PxVehicleWheelQueryResult* vehicleQueryResult = nullptr, float deltaTime = 0.f);
+	void						ResetStateHistory();
+	const VehicleStateSnapshot&	GetStateSnapshot() const;
+	//Contacts, slip and suspension for each wheel from the last vehicle update, on the physics side
+	const WheelContactState&	GetWheelContactState(int wheelIndex) const;
+	int							GetNumWheelContactStates() const;
+	bool						IsVehicleInAir() const;
+
 	//Vehicle Controls
 	void	AccelerateForward(float analogAcc = 0.f);
 	void	AccelerateReverse(float analogAcc = 0.f);
@@ -54,6 +71,10 @@ public:
 	void	ReleaseVehicle();
 	bool	IsControlReleased();
 
+private:
+	void	RecordWheelContacts(VehicleState& state, const PxVehicleWheelQueryResult& vehicleQueryResult);
+	void	RecordWheelSpin(VehicleState& state, float deltaTime);
+
 private:
 
 	int			m_controllerID = 0;
@@ -65,6 +86,8 @@ private:
 	PxVehicleDrive4W*					m_vehicle4W = nullptr;
 	PxVehicleDrive4WRawInputData*		m_vehicleInputData = nullptr;
 
+	VehicleStateSnapshot				m_stateSnapshot;
+
 public:
 	bool								m_controlReleased = false;
 
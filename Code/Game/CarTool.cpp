@@ -1,6 +1,15 @@
 #include "Game/CarTool.hpp"
 #include "Engine/Renderer/ImGUISystem.hpp"
 #include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/MathUtils.hpp"
+//Third party
+#include "ThirdParty/TinyXML2/tinyxml2.h"
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Limits for the simulation settings, shared by the sliders and the values read from file
+constexpr int MAX_WHEEL_SUB_STEPS = 32;
+constexpr float MAX_SUB_STEP_THRESHOLD_SPEED = 100.f;
 
 //------------------------------------------------------------------------------------------------------------------------------
 CarTool::CarTool()
@@ -15,7 +24,7 @@ CarTool::~CarTool()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void CarTool::UpdateImGUICarTool()
+void CarTool::UpdateImGUICarTool(VehicleManager& vehicleManager)
 {
 	ImGui::Begin("Car Tuner");
 
@@ -37,6 +46,9 @@ void CarTool::UpdateImGUICarTool()
 	UpdateGearData();
 	ImGui::NextColumn();
 
+	UpdateSimulationData(vehicleManager);
+	ImGui::NextColumn();
+
 	ImGui::PopStyleVar();
 	ImGui::End();
 }
@@ -44,6 +56,11 @@ void CarTool::UpdateImGUICarTool()
 //------------------------------------------------------------------------------------------------------------------------------
 physx::PxVehicleDrive4W* CarTool::MakeNewCar()
 {
+	UpdateDerivedVehicleDesc();
+	m_builtChassisDims = m_vehicleDesc.chassisDims;
+	m_builtWheelRadius = m_vehicleDesc.wheelRadius;
+	m_builtWheelWidth = m_vehicleDesc.wheelWidth;
+
 	//First ensure m_driveSimData is correctly setup
 	m_driveSimData.setEngineData(m_engineData);
 	m_driveSimData.setClutchData(m_clutchData);
@@ -54,7 +71,136 @@ physx::PxVehicleDrive4W* CarTool::MakeNewCar()
 	m_vehicleDesc.wheelMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
 	m_vehicleDesc.chassisMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
 
-	return g_PxPhysXSystem->CreateCustomVehicle4W(m_vehicleDesc, m_driveSimData);
+	PxVehicleDrive4W* vehicle = g_PxPhysXSystem->CreateCustomVehicle4W(m_vehicleDesc, m_driveSimData);
+	if (vehicle != nullptr)
+	{
+		ApplySubStepsToVehicle(*vehicle);
+	}
+
+	return vehicle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::ApplyToVehicle(PxVehicleDrive4W& vehicle)
+{
+	UpdateDerivedVehicleDesc();
+
+	//Drive train. The setters work out the reciprocals and anything else derived, same as on create
+	vehicle.mDriveSimData.setEngineData(m_engineData);
+	vehicle.mDriveSimData.setClutchData(m_clutchData);
+	vehicle.mDriveSimData.setDiffData(m_differnetialData);
+	vehicle.mDriveSimData.setGearsData(m_gearData);
+
+	//Chassis mass and inertia. The centre of mass only moves with the dimensions, which goes through a rebuild instead
+	PxRigidDynamic* actor = vehicle.getRigidDynamicActor();
+	actor->setMass(m_vehicleDesc.chassisMass);
+	actor->setMassSpaceInertiaTensor(m_vehicleDesc.chassisMOI);
+
+	//Sprung masses follow the chassis mass. Wheel centre offsets are already relative to the centre of mass
+	PxVehicleWheelsSimData& wheelsSimData = vehicle.mWheelsSimData;
+	const PxU32 numWheels = wheelsSimData.getNbWheels();
+
+	PxVec3 wheelCentreOffsets[PX_MAX_NB_WHEELS];
+	PxF32 sprungMasses[PX_MAX_NB_WHEELS];
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; wheelIndex++)
+	{
+		wheelCentreOffsets[wheelIndex] = wheelsSimData.getWheelCentreOffset(wheelIndex);
+	}
+	PxVehicleComputeSprungMasses(numWheels, wheelCentreOffsets, PxVec3(0.f), m_vehicleDesc.chassisMass, 1, sprungMasses);
+
+	for (PxU32 wheelIndex = 0; wheelIndex < numWheels; wheelIndex++)
+	{
+		PxVehicleWheelData wheelData = wheelsSimData.getWheelData(wheelIndex);
+		wheelData.mMass = m_vehicleDesc.wheelMass;
+		wheelData.mMOI = m_vehicleDesc.wheelMOI;
+		wheelsSimData.setWheelData(wheelIndex, wheelData);
+
+		PxVehicleSuspensionData suspensionData = wheelsSimData.getSuspensionData(wheelIndex);
+		suspensionData.setMassAndPreserveNaturalFrequency(sprungMasses[wheelIndex]);
+		wheelsSimData.setSuspensionData(wheelIndex, suspensionData);
+	}
+
+	ApplySubStepsToVehicle(vehicle);
+
+	actor->wakeUp();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool CarTool::HasVehicleGeometryChanged() const
+{
+	return m_vehicleDesc.chassisDims != m_builtChassisDims || m_vehicleDesc.wheelRadius != m_builtWheelRadius || m_vehicleDesc.wheelWidth != m_builtWheelWidth;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::LoadParameterSet(const XMLElement& parameterSet)
+{
+	//Wheel
+	m_vehicleDesc.wheelWidth = ParseXmlAttribute(parameterSet, "wheelWidth", m_vehicleDesc.wheelWidth);
+	m_vehicleDesc.wheelMass = ParseXmlAttribute(parameterSet, "wheelMass", m_vehicleDesc.wheelMass);
+	m_vehicleDesc.wheelRadius = ParseXmlAttribute(parameterSet, "wheelRadius", m_vehicleDesc.wheelRadius);
+
+	//Chassis
+	m_vehicleDesc.chassisMass = ParseXmlAttribute(parameterSet, "chassisMass", m_vehicleDesc.chassisMass);
+	Vec3 chassisDims = ParseXmlAttribute(parameterSet, "chassisDims", PhysXSystem::PxVectorToVec(m_vehicleDesc.chassisDims));
+	m_vehicleDesc.chassisDims = PhysXSystem::VecToPxVector(chassisDims);
+
+	//Differential, the type uses the same names as the tool's combo box
+	m_differnetialData.mFrontRearSplit = ParseXmlAttribute(parameterSet, "diffFrontRearSplit", m_differnetialData.mFrontRearSplit);
+	m_differnetialData.mFrontLeftRightSplit = ParseXmlAttribute(parameterSet, "diffFrontLeftRightSplit", m_differnetialData.mFrontLeftRightSplit);
+	m_differnetialData.mRearLeftRightSplit = ParseXmlAttribute(parameterSet, "diffRearLeftRightSplit", m_differnetialData.mRearLeftRightSplit);
+	m_differnetialData.mCentreBias = ParseXmlAttribute(parameterSet, "diffCenterBias", m_differnetialData.mCentreBias);
+	m_differnetialData.mFrontBias = ParseXmlAttribute(parameterSet, "diffFrontBias", m_differnetialData.mFrontBias);
+	m_differnetialData.mRearBias = ParseXmlAttribute(parameterSet, "diffRearBias", m_differnetialData.mRearBias);
+
+	const char* diffTypeNames[] = { "LS_4WD", "LS_FWD", "LS_RWD", "O_4WD", "O_FWD", "O_RWD" };
+	std::string diffType = ParseXmlAttribute(parameterSet, "diffType", std::string(diffTypeNames[m_differnetialData.mType]));
+	for (int typeIndex = 0; typeIndex < PxVehicleDifferential4WData::eMAX_NB_DIFF_TYPES; typeIndex++)
+	{
+		if (diffType == diffTypeNames[typeIndex])
+		{
+			m_differnetialData.mType = (PxVehicleDifferential4WData::Enum)typeIndex;
+		}
+	}
+
+	//Engine
+	m_engineData.mMOI = ParseXmlAttribute(parameterSet, "engineMOI", m_engineData.mMOI);
+	m_engineData.mPeakTorque = ParseXmlAttribute(parameterSet, "peakTorque", m_engineData.mPeakTorque);
+	m_engineData.mMaxOmega = ParseXmlAttribute(parameterSet, "maxOmega", m_engineData.mMaxOmega);
+	m_engineData.mDampingRateFullThrottle = ParseXmlAttribute(parameterSet, "dampingFullThrottle", m_engineData.mDampingRateFullThrottle);
+	m_engineData.mDampingRateZeroThrottleClutchEngaged = ParseXmlAttribute(parameterSet, "dampingZeroThrottleClutchEngaged", m_engineData.mDampingRateZeroThrottleClutchEngaged);
+	m_engineData.mDampingRateZeroThrottleClutchDisengaged = ParseXmlAttribute(parameterSet, "dampingZeroThrottleClutchDisengaged", m_engineData.mDampingRateZeroThrottleClutchDisengaged);
+
+	//Gears
+	m_gearData.mFinalRatio = ParseXmlAttribute(parameterSet, "finalRatio", m_gearData.mFinalRatio);
+	m_gearData.mSwitchTime = ParseXmlAttribute(parameterSet, "switchTime", m_gearData.mSwitchTime);
+	m_gearData.mRatios[PxVehicleGearsData::eREVERSE] = ParseXmlAttribute(parameterSet, "ratioReverse", m_gearData.mRatios[PxVehicleGearsData::eREVERSE]);
+	m_gearData.mRatios[PxVehicleGearsData::eFIRST] = ParseXmlAttribute(parameterSet, "ratioFirst", m_gearData.mRatios[PxVehicleGearsData::eFIRST]);
+	m_gearData.mRatios[PxVehicleGearsData::eSECOND] = ParseXmlAttribute(parameterSet, "ratioSecond", m_gearData.mRatios[PxVehicleGearsData::eSECOND]);
+	m_gearData.mRatios[PxVehicleGearsData::eTHIRD] = ParseXmlAttribute(parameterSet, "ratioThird", m_gearData.mRatios[PxVehicleGearsData::eTHIRD]);
+	m_gearData.mRatios[PxVehicleGearsData::eFOURTH] = ParseXmlAttribute(parameterSet, "ratioFourth", m_gearData.mRatios[PxVehicleGearsData::eFOURTH]);
+	m_gearData.mRatios[PxVehicleGearsData::eFIFTH] = ParseXmlAttribute(parameterSet, "ratioFifth", m_gearData.mRatios[PxVehicleGearsData::eFIFTH]);
+
+	//Clutch
+	m_clutchData.mStrength = ParseXmlAttribute(parameterSet, "clutchStrength", m_clutchData.mStrength);
+
+	//Sub-steps
+	m_subStepThresholdSpeed = ParseXmlAttribute(parameterSet, "thresholdSpeed", m_subStepThresholdSpeed);
+	m_lowSpeedSubSteps = ParseXmlAttribute(parameterSet, "lowSpeedSubSteps", m_lowSpeedSubSteps);
+	m_highSpeedSubSteps = ParseXmlAttribute(parameterSet, "highSpeedSubSteps", m_highSpeedSubSteps);
+	ClampSimulationSettings();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::UpdateDerivedVehicleDesc()
+{
+	//The tool only edits the base values, keep everything computed from them in step
+	m_vehicleDesc.chassisMOI =
+		PxVec3((m_vehicleDesc.chassisDims.y*m_vehicleDesc.chassisDims.y + m_vehicleDesc.chassisDims.z*m_vehicleDesc.chassisDims.z)*m_vehicleDesc.chassisMass / 12.0f,
+		(m_vehicleDesc.chassisDims.x*m_vehicleDesc.chassisDims.x + m_vehicleDesc.chassisDims.z*m_vehicleDesc.chassisDims.z)*0.8f*m_vehicleDesc.chassisMass / 12.0f,
+			(m_vehicleDesc.chassisDims.x*m_vehicleDesc.chassisDims.x + m_vehicleDesc.chassisDims.y*m_vehicleDesc.chassisDims.y)*m_vehicleDesc.chassisMass / 12.0f);
+	m_vehicleDesc.chassisCMOffset = PxVec3(0.0f, -m_vehicleDesc.chassisDims.y*0.5f + 0.65f, 0.25f);
+
+	m_vehicleDesc.wheelMOI = 0.5f*m_vehicleDesc.wheelMass*m_vehicleDesc.wheelRadius*m_vehicleDesc.wheelRadius;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -73,21 +219,19 @@ void CarTool::SetDefaultVehicleDesc()
 {
 	m_vehicleDesc.chassisMass = 1500.f;
 	m_vehicleDesc.chassisDims = PxVec3(2.5f, 1.20f, 5.0f);
-
-	m_vehicleDesc.chassisMOI =
-		PxVec3((m_vehicleDesc.chassisDims.y*m_vehicleDesc.chassisDims.y + m_vehicleDesc.chassisDims.z*m_vehicleDesc.chassisDims.z)*m_vehicleDesc.chassisMass / 12.0f,
-		(m_vehicleDesc.chassisDims.x*m_vehicleDesc.chassisDims.x + m_vehicleDesc.chassisDims.z*m_vehicleDesc.chassisDims.z)*0.8f*m_vehicleDesc.chassisMass / 12.0f,
-			(m_vehicleDesc.chassisDims.x*m_vehicleDesc.chassisDims.x + m_vehicleDesc.chassisDims.y*m_vehicleDesc.chassisDims.y)*m_vehicleDesc.chassisMass / 12.0f);
-	m_vehicleDesc.chassisCMOffset = PxVec3(0.0f, -m_vehicleDesc.chassisDims.y*0.5f + 0.65f, 0.25f);
-
 	//Set up the wheel mass, radius, width, moment of inertia, and number of wheels.
 	//Moment of inertia is just the moment of inertia of a cylinder.
 	m_vehicleDesc.wheelMass = 20.0f;
 	m_vehicleDesc.wheelRadius = 0.5f;
 	m_vehicleDesc.wheelWidth = 0.4f;
-	m_vehicleDesc.wheelMOI = 0.5f*m_vehicleDesc.wheelMass*m_vehicleDesc.wheelRadius*m_vehicleDesc.wheelRadius;
 	m_vehicleDesc.numWheels = 4;
 
+	//The start up vehicles from the engine use these same defaults
+	m_builtChassisDims = m_vehicleDesc.chassisDims;
+	m_builtWheelRadius = m_vehicleDesc.wheelRadius;
+	m_builtWheelWidth = m_vehicleDesc.wheelWidth;
+	UpdateDerivedVehicleDesc();
+
 	m_chassisSimFilter = PxFilterData(COLLISION_FLAG_CHASSIS, COLLISION_FLAG_CHASSIS_AGAINST, 0, 0);
 	m_wheelSimFilter = PxFilterData(COLLISION_FLAG_WHEEL, COLLISION_FLAG_WHEEL_AGAINST, PxPairFlag::eDETECT_CCD_CONTACT | PxPairFlag::eMODIFY_CONTACTS, 0);
 
@@ -303,3 +447,133 @@ void CarTool::UpdateClutchData()
 	ImGui::EndChild();
 }
 
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::ApplySimulationSettings(VehicleManager& vehicleManager) const
+{
+	vehicleManager.SetWheelContactMode(m_wheelContactMode, (uint)m_numSweepHitsPerWheel);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::ApplySubStepsToVehicle(PxVehicleWheels& vehicle) const
+{
+	vehicle.mWheelsSimData.setSubStepCount(m_subStepThresholdSpeed, (PxU32)m_lowSpeedSubSteps, (PxU32)m_highSpeedSubSteps);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool CarTool::ConsumeSubStepSettingsChanged()
+{
+	bool hasChanged = m_subStepSettingsChanged;
+	m_subStepSettingsChanged = false;
+	return hasChanged;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::ClampSimulationSettings()
+{
+	//Anything out of range in the file would wrap around when cast to the unsigned counts PhysX takes
+	m_numSweepHitsPerWheel = Clamp(m_numSweepHitsPerWheel, 1, (int)MAX_SWEEP_HITS_PER_WHEEL);
+	m_subStepThresholdSpeed = Clamp(m_subStepThresholdSpeed, 0.f, MAX_SUB_STEP_THRESHOLD_SPEED);
+	m_lowSpeedSubSteps = Clamp(m_lowSpeedSubSteps, 1, MAX_WHEEL_SUB_STEPS);
+	m_highSpeedSubSteps = Clamp(m_highSpeedSubSteps, 1, MAX_WHEEL_SUB_STEPS);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool CarTool::LoadSimulationSettings()
+{
+	tinyxml2::XMLDocument settingsDoc;
+	settingsDoc.LoadFile(m_simulationSettingsPath.c_str());
+
+	if (settingsDoc.ErrorID() != tinyxml2::XML_SUCCESS)
+	{
+		DebuggerPrintf("\n >> Error loading vehicle simulation settings %s, using defaults", m_simulationSettingsPath.c_str());
+		return false;
+	}
+
+	XMLElement* root = settingsDoc.RootElement();
+
+	XMLElement* contactElement = root->FirstChildElement("WheelContact");
+	if (contactElement != nullptr)
+	{
+		bool useSweeps = ParseXmlAttribute(*contactElement, "useSweeps", false);
+		m_wheelContactMode = useSweeps ? WHEEL_CONTACT_SWEEP : WHEEL_CONTACT_RAYCAST;
+		m_numSweepHitsPerWheel = ParseXmlAttribute(*contactElement, "sweepHitsPerWheel", m_numSweepHitsPerWheel);
+	}
+
+	XMLElement* subStepElement = root->FirstChildElement("SubSteps");
+	if (subStepElement != nullptr)
+	{
+		m_subStepThresholdSpeed = ParseXmlAttribute(*subStepElement, "thresholdSpeed", m_subStepThresholdSpeed);
+		m_lowSpeedSubSteps = ParseXmlAttribute(*subStepElement, "lowSpeedSubSteps", m_lowSpeedSubSteps);
+		m_highSpeedSubSteps = ParseXmlAttribute(*subStepElement, "highSpeedSubSteps", m_highSpeedSubSteps);
+	}
+
+	ClampSimulationSettings();
+	m_subStepSettingsChanged = true;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::SaveSimulationSettings() const
+{
+	tinyxml2::XMLDocument settingsDoc;
+
+	XMLElement* root = settingsDoc.NewElement("VehicleSimulation");
+	settingsDoc.InsertFirstChild(root);
+
+	XMLElement* contactElement = settingsDoc.NewElement("WheelContact");
+	contactElement->SetAttribute("useSweeps", m_wheelContactMode == WHEEL_CONTACT_SWEEP);
+	contactElement->SetAttribute("sweepHitsPerWheel", m_numSweepHitsPerWheel);
+	root->InsertEndChild(contactElement);
+
+	XMLElement* subStepElement = settingsDoc.NewElement("SubSteps");
+	subStepElement->SetAttribute("thresholdSpeed", m_subStepThresholdSpeed);
+	subStepElement->SetAttribute("lowSpeedSubSteps", m_lowSpeedSubSteps);
+	subStepElement->SetAttribute("highSpeedSubSteps", m_highSpeedSubSteps);
+	root->InsertEndChild(subStepElement);
+
+	if (settingsDoc.SaveFile(m_simulationSettingsPath.c_str()) != tinyxml2::XML_SUCCESS)
+	{
+		DebuggerPrintf("\n >> Error saving vehicle simulation settings %s", m_simulationSettingsPath.c_str());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void CarTool::UpdateSimulationData(VehicleManager& vehicleManager)
+{
+	ImGuiWindowFlags window_flags = ImGuiWindowFlags_HorizontalScrollbar;
+	ImGui::BeginChild("Simulation Editor", ImVec2(m_defaultColumnWidth, m_defaultColumnHeight), true, window_flags);
+
+	ImGui::Text("Simulation Editor");
+
+	//Raycasts are the fast option, sweeps are the quality option for tracks built from many collider pieces
+	int contactMode = (int)m_wheelContactMode;
+	ImGui::RadioButton("Raycast (Perf)", &contactMode, WHEEL_CONTACT_RAYCAST);
+	ImGui::SameLine();
+	ImGui::RadioButton("Sweep (Quality)", &contactMode, WHEEL_CONTACT_SWEEP);
+	m_wheelContactMode = (eWheelContactMode)contactMode;
+
+	ImGui::SliderInt("Sweep Hits Per Wheel", &m_numSweepHitsPerWheel, 1, MAX_SWEEP_HITS_PER_WHEEL);
+
+	//Wheel sub-steps, more steps above the threshold keeps the tires stable at speed without raising the physics rate
+	bool subStepsChanged = ImGui::DragFloat("Sub-Step Threshold Speed: ", &m_subStepThresholdSpeed, 0.1f, 0.f, MAX_SUB_STEP_THRESHOLD_SPEED);
+	subStepsChanged |= ImGui::SliderInt("Sub-Steps Below Threshold", &m_lowSpeedSubSteps, 1, MAX_WHEEL_SUB_STEPS);
+	subStepsChanged |= ImGui::SliderInt("Sub-Steps Above Threshold", &m_highSpeedSubSteps, 1, MAX_WHEEL_SUB_STEPS);
+	if (subStepsChanged)
+	{
+		ClampSimulationSettings();
+		m_subStepSettingsChanged = true;
+	}
+
+	ApplySimulationSettings(vehicleManager);
+
+	ImGui::Text("Vehicle update: %.1f us/tick (last %.1f us)", vehicleManager.GetAverageUpdateTimeSeconds() * 1000000.0, vehicleManager.GetLastUpdateTimeSeconds() * 1000000.0);
+	ImGui::Text("%u vehicles, %u worker threads", vehicleManager.GetNumVehicles(), vehicleManager.GetNumWorkerThreads());
+
+	if (ImGui::Button("Save Simulation Settings"))
+	{
+		SaveSimulationSettings();
+	}
+
+	ImGui::EndChild();
+}
@@ -1,5 +1,9 @@
 #pragma once
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Engine/Core/XMLUtils/XMLUtils.hpp"
+//Game Systems
+#include "Game/VehicleManager.hpp"
+#include <string>
 
 class CarTool
 {
@@ -7,16 +11,40 @@ public:
 	CarTool();
 	~CarTool();
 
-	void					UpdateImGUICarTool();
+	//The wheel contact mode is applied to the vehicle manager straight away, it doesn't need the cars re-created
+	void					UpdateImGUICarTool(VehicleManager& vehicleManager);
+	void					ApplySimulationSettings(VehicleManager& vehicleManager) const;
+
+	//Sub-steps live in each vehicle's wheel sim data. New cars and ApplyToVehicle get them, the tool flags slider changes so
+	//the game can push them into the live cars without waiting for a reset
+	void					ApplySubStepsToVehicle(PxVehicleWheels& vehicle) const;
+	bool					ConsumeSubStepSettingsChanged();
+
+	//Wheel contact and sub-step settings persist between runs. Values from the file are clamped to what the tool allows
+	bool					LoadSimulationSettings();
+	void					SaveSimulationSettings() const;
 	PxVehicleDrive4W*		MakeNewCar();
 
+	//Engine, gears, clutch, differential, chassis mass and wheel mass/MOI all go straight into a live vehicle's sim data
+	void					ApplyToVehicle(PxVehicleDrive4W& vehicle);
+	//Chassis dimensions and wheel radius/width feed the convex meshes, wheel centre offsets, suspension and tire force
+	//offsets and the wheel shape poses, so any of those needs a new vehicle from MakeNewCar
+	bool					HasVehicleGeometryChanged() const;
+
+	//Reads one parameter set for the tuning evaluator. Attributes use the tool's slider names, anything missing keeps its value.
+	//Sub-steps can be set per parameter set, so every car in a sweep can run its own
+	void					LoadParameterSet(const XMLElement& parameterSet);
+
 private:
+	void		ClampSimulationSettings();
+
 	void		SetAllDefaults();
 	void		SetDefaultVehicleDesc();
 	void		SetDefaultDifferentialData();
 	void		SetDefaultEngineData();
 	void		SetDefaultGearData();
 	void		SetDefaultClutchData();
+	void		UpdateDerivedVehicleDesc();
 
 	void		UpdateWheelData();
 	void		UpdateChassisData();
@@ -24,10 +52,14 @@ private:
 	void		UpdateEngineData();
 	void		UpdateGearData();
 	void		UpdateClutchData();
+	void		UpdateSimulationData(VehicleManager& vehicleManager);
 
 private:
 
 	VehicleDesc						m_vehicleDesc;
+	PxVec3							m_builtChassisDims = PxVec3(0.f);	//What the live vehicles were made with
+	float							m_builtWheelRadius = 0.f;
+	float							m_builtWheelWidth = 0.f;
 	PxVehicleDriveSimData4W			m_driveSimData;
 
 	//Internal for DriveSimData
@@ -43,6 +75,14 @@ private:
 	ActorUserData					m_actorUserData;
 	ShapeUserData					m_shapeUserData[PX_MAX_NB_WHEELS];
 
+	eWheelContactMode				m_wheelContactMode = WHEEL_CONTACT_RAYCAST;
+	int								m_numSweepHitsPerWheel = 4;
+	float							m_subStepThresholdSpeed = 5.f;
+	int								m_lowSpeedSubSteps = 3;
+	int								m_highSpeedSubSteps = 1;
+	bool							m_subStepSettingsChanged = false;
+	std::string						m_simulationSettingsPath = "Data/Gameplay/VehicleSimulation.xml";
+
 	float							m_defaultColumnHeight = 150.f;
 	float							m_defaultColumnWidth = 500.f;
 };
\ No newline at end of file
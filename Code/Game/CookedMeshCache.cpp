@@ -0,0 +1,219 @@
+#include "Game/CookedMeshCache.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+//Third Party
+#include <direct.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static const char*		COOKED_CACHE_DIRECTORY = "Data/CookedCache";
+
+static const uint64_t	FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t	FNV_PRIME = 1099511628211ULL;
+
+static uint				s_numHits = 0;
+static uint				s_numMisses = 0;
+static double			s_loadSeconds = 0.0;
+static double			s_cookSeconds = 0.0;
+
+//------------------------------------------------------------------------------------------------------------------------------
+//FNV-1a, cheap and stable across runs which is all we need for a cache key
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t numBytes)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t byteIndex = 0; byteIndex < numBytes; byteIndex++)
+	{
+		hash ^= bytes[byteIndex];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename T>
+static uint64_t HashValue(uint64_t hash, const T& value)
+{
+	return HashBytes(hash, &value, sizeof(T));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Descs can be strided, so only hash the bytes of each element and not whatever sits between them
+static uint64_t HashBoundedData(uint64_t hash, const PxBoundedData& boundedData, size_t elementSize)
+{
+	hash = HashValue(hash, boundedData.count);
+
+	const unsigned char* element = (const unsigned char*)boundedData.data;
+	if (element == nullptr)
+	{
+		return hash;
+	}
+
+	for (PxU32 elementIndex = 0; elementIndex < boundedData.count; elementIndex++)
+	{
+		hash = HashBytes(hash, element, elementSize);
+		element += boundedData.stride;
+	}
+
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Everything in the params that can change the cooked bytes. The SDK version goes in too since streams don't load across versions
+static uint64_t HashCookingParams(uint64_t hash, const PxCookingParams& params)
+{
+	hash = HashValue(hash, (PxU32)PX_PHYSICS_VERSION);
+	hash = HashValue(hash, params.areaTestEpsilon);
+	hash = HashValue(hash, params.planeTolerance);
+	hash = HashValue(hash, (PxU32)params.convexMeshCookingType);
+	hash = HashValue(hash, params.suppressTriangleMeshRemapTable);
+	hash = HashValue(hash, params.buildTriangleAdjacencies);
+	hash = HashValue(hash, params.buildGPUData);
+	hash = HashValue(hash, params.scale.length);
+	hash = HashValue(hash, params.scale.speed);
+	hash = HashValue(hash, (PxU32)params.meshPreprocessParams);
+	hash = HashValue(hash, params.meshWeldTolerance);
+	hash = HashValue(hash, params.gaussMapLimit);
+
+	PxMeshMidPhase::Enum midphaseType = params.midphaseDesc.getType();
+	hash = HashValue(hash, (PxU32)midphaseType);
+	if (midphaseType == PxMeshMidPhase::eBVH34)
+	{
+		hash = HashValue(hash, params.midphaseDesc.mBVH34Desc.numPrimsPerLeaf);
+	}
+	else
+	{
+		hash = HashValue(hash, (PxU32)params.midphaseDesc.mBVH33Desc.meshCookingHint);
+		hash = HashValue(hash, params.midphaseDesc.mBVH33Desc.meshSizePerformanceTradeOff);
+	}
+
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxConvexMesh* CookedMeshCache::GetOrCookConvexMesh(const PxConvexMeshDesc& convexDesc)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxCooking* cooking = g_PxPhysXSystem->GetPhysXCookingModule();
+
+	std::string cacheFilePath = GetCacheFilePath(HashConvexSource(convexDesc, cooking->getParams()), "pxconvex");
+
+	double startTime = GetCurrentTimeSeconds();
+	{
+		PxDefaultFileInputData cachedStream(cacheFilePath.c_str());
+		if (cachedStream.isValid())
+		{
+			PxConvexMesh* convexMesh = physX->createConvexMesh(cachedStream);
+			if (convexMesh != nullptr)
+			{
+				s_numHits++;
+				s_loadSeconds += GetCurrentTimeSeconds() - startTime;
+				return convexMesh;
+			}
+
+			//Unreadable or from another SDK build, cook it again below and overwrite it
+		}
+	}
+
+	startTime = GetCurrentTimeSeconds();
+	PxDefaultMemoryOutputStream cookedStream;
+	PxConvexMeshCookingResult::Enum result;
+	if (!cooking->cookConvexMesh(convexDesc, cookedStream, &result))
+	{
+		DebuggerPrintf("\n >> Failed to cook convex mesh for %s", cacheFilePath.c_str());
+		return nullptr;
+	}
+
+	s_numMisses++;
+	s_cookSeconds += GetCurrentTimeSeconds() - startTime;
+
+	WriteCacheFile(cacheFilePath, cookedStream);
+
+	PxDefaultMemoryInputData cookedInput(cookedStream.getData(), cookedStream.getSize());
+	return physX->createConvexMesh(cookedInput);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxConvexMesh* CookedMeshCache::CreateWedgeConvexMesh(const PxVec3& halfExtents)
+{
+	//Flat on y = 0 and rising to full height at +z, so a ramp placed on the ground sits on it
+	const PxF32 x = halfExtents.x;
+	const PxF32 y = halfExtents.y * 2.0f;
+	const PxF32 z = halfExtents.z;
+
+	PxVec3 vertices[6] =
+	{
+		PxVec3(-x, 0.f, -z),
+		PxVec3(-x, 0.f, +z),
+		PxVec3(-x, y, +z),
+		PxVec3(+x, 0.f, -z),
+		PxVec3(+x, 0.f, +z),
+		PxVec3(+x, y, +z)
+	};
+
+	PxConvexMeshDesc convexDesc;
+	convexDesc.points.count = 6;
+	convexDesc.points.stride = sizeof(PxVec3);
+	convexDesc.points.data = vertices;
+	convexDesc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
+
+	return GetOrCookConvexMesh(convexDesc);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t CookedMeshCache::HashConvexSource(const PxConvexMeshDesc& convexDesc, const PxCookingParams& params)
+{
+	uint64_t hash = HashCookingParams(FNV_OFFSET_BASIS, params);
+
+	hash = HashValue(hash, (PxU32)convexDesc.flags);
+	hash = HashValue(hash, convexDesc.vertexLimit);
+	hash = HashValue(hash, convexDesc.quantizedCount);
+	hash = HashBoundedData(hash, convexDesc.points, sizeof(PxVec3));
+
+	//Only set when the caller supplies its own hull instead of eCOMPUTE_CONVEX
+	hash = HashBoundedData(hash, convexDesc.polygons, sizeof(PxHullPolygon));
+	bool has16BitIndices = convexDesc.flags & PxConvexFlag::e16_BIT_INDICES;
+	hash = HashBoundedData(hash, convexDesc.indices, has16BitIndices ? sizeof(PxU16) : sizeof(PxU32));
+
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC std::string CookedMeshCache::GetCacheFilePath(uint64_t sourceHash, const char* extension)
+{
+	return Stringf("%s/%016llx.%s", COOKED_CACHE_DIRECTORY, (unsigned long long)sourceHash, extension);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool CookedMeshCache::WriteCacheFile(const std::string& filePath, PxDefaultMemoryOutputStream& cookedStream)
+{
+	//Fails harmlessly when the directory is already there
+	_mkdir(COOKED_CACHE_DIRECTORY);
+
+	PxDefaultFileOutputStream writeStream(filePath.c_str());
+	if (!writeStream.isValid())
+	{
+		DebuggerPrintf("\n >> Could not write cooked mesh cache file %s", filePath.c_str());
+		return false;
+	}
+
+	return writeStream.write(cookedStream.getData(), cookedStream.getSize()) == cookedStream.getSize();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void CookedMeshCache::RegisterConsoleCommands()
+{
+	g_eventSystem->SubscribeEventCallBackFn("CookedCacheStats", Command_CookedCacheStats);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool CookedMeshCache::Command_CookedCacheStats(EventArgs& args)
+{
+	UNUSED(args);
+
+	g_devConsole->PrintString(Rgba::ORGANIC_BLUE, Stringf("Cooked mesh cache: %s", COOKED_CACHE_DIRECTORY));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Hits:   %u, %.2f ms loading", s_numHits, s_loadSeconds * 1000.0));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Misses: %u, %.2f ms cooking", s_numMisses, s_cookSeconds * 1000.0));
+	return true;
+}
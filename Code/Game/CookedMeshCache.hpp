@@ -0,0 +1,35 @@
+#pragma once
+//Engine Systems
+#include "Engine/Core/EventSystems.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Third Party
+#include "extensions/PxDefaultStreams.h"
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Disk cache for convex meshes the game cooks itself. The key is a hash of the source vertices/indices, the mesh flags and the
+// cooking params that change the cooked output, so a change to any of those just misses and cooks again.
+// Only the ramp wedges and the track baker's piece actors come through here. The wheel and chassis hulls made inside the
+// engine's CreateCustomVehicle4W and the per-piece track colliders from the engine's mesh loader are still cooked on every
+// launch, the engine doesn't let us hand it a mesh. The merged track loads pre-cooked files instead
+//------------------------------------------------------------------------------------------------------------------------------
+class CookedMeshCache
+{
+public:
+	//Returns a mesh with one reference owned by the caller, or nullptr if the source can't be cooked
+	static PxConvexMesh*	GetOrCookConvexMesh(const PxConvexMeshDesc& convexDesc);
+
+	//Same wedge the engine's CreateWedgeConvexMesh builds, but cooked through the cache
+	static PxConvexMesh*	CreateWedgeConvexMesh(const PxVec3& halfExtents);
+
+	static uint64_t			HashConvexSource(const PxConvexMeshDesc& convexDesc, const PxCookingParams& params);
+	static std::string		GetCacheFilePath(uint64_t sourceHash, const char* extension);
+
+	static void				RegisterConsoleCommands();
+
+	//CookedCacheStats. Prints hits, misses and time spent cooking vs loading since launch
+	static bool				Command_CookedCacheStats(EventArgs& args);
+
+private:
+	static bool				WriteCacheFile(const std::string& filePath, PxDefaultMemoryOutputStream& cookedStream);
+};
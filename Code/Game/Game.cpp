@@ -6,6 +6,7 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/EventSystems.hpp"
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/NamedStrings.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Core/WindowContext.hpp"
@@ -32,6 +33,11 @@
 #include "Engine/Renderer/ObjectLoader.hpp"
 #include "Engine/Core/FileUtils.hpp"
 //Game Systems
+#include "Game/CookedMeshCache.hpp"
+#include "Game/ObstacleClusterBuilder.hpp"
+#include "Game/TrackBenchmarks.hpp"
+#include "Game/TrackCollisionBaker.hpp"
+#include "Game/TuningEvaluator.hpp"
 #include "Game/UIWidget.hpp"
 //Third party
 #include "ThirdParty/TinyXML2/tinyxml2.h"
@@ -82,6 +88,29 @@ void Game::StartUp()
 	m_mainCamera->SetEuler(camEuler);
 
 	ReadBestTimeFromTextFile();
+	m_bestSplits.LoadFromTextFile(m_bestSplitsFilePath);
+	m_carTool.LoadSimulationSettings();
+
+	TrackBenchmarks::RegisterConsoleCommands();
+	TrackCollisionBaker::RegisterConsoleCommands();
+	CookedMeshCache::RegisterConsoleCommands();
+	ObstacleClusterBuilder::RegisterConsoleCommands();
+	TuningEvaluator::RegisterConsoleCommands();
+	m_useMergedTrackCollision = g_gameConfigBlackboard.GetValue("useMergedTrackCollision", m_useMergedTrackCollision);
+
+	//Surface names are resolved here, the shapes only ever carry the table index
+	m_tireSurfaces.LoadFromXMLFile(m_tireSurfacesPath);
+	m_tireSurfaces.Startup();
+	m_vehicleManager.SetTireFrictionPairs(m_tireSurfaces.GetFrictionPairs());
+	m_groundSurface = TireSurfaceTable::GetSurfaceForName(g_gameConfigBlackboard.GetValue("groundSurface", std::string("road")));
+
+	float activationDistance = g_gameConfigBlackboard.GetValue("obstacleActivationDistance", 30.f);
+	float deactivationDistance = g_gameConfigBlackboard.GetValue("obstacleDeactivationDistance", 45.f);
+	m_obstacleActivation.SetActivationDistances(activationDistance, deactivationDistance);
+	int maxSettlingTicks = g_gameConfigBlackboard.GetValue("obstacleMaxSettlingTicks", 200);
+	m_obstacleActivation.SetMaxSettlingTicks((uint)Clamp(maxSettlingTicks, 0, 10000));
+	m_spawnObstacleClusters = g_gameConfigBlackboard.GetValue("spawnObstacleClusters", m_spawnObstacleClusters);
+	m_obstacleInsertMode = ObstacleClusterBuilder::GetInsertModeForName(g_gameConfigBlackboard.GetValue("obstacleClusterInsertMode", std::string("aggregates")));
 
 	CreateInitialMeshes();
 	//LoadGameTexturesThreaded();
@@ -118,14 +147,35 @@ void Game::InitiateGameSequence()
 
 	//Setup the cars	
 	SetupCars();
+	m_vehicleManager.Startup();
+	m_carTool.ApplySimulationSettings(m_vehicleManager);
+
+	//Cars render from the published snapshot, so publish the spawn state once before the first physics tick
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		m_cars[carIndex]->SetVehicleSnapshot(&m_vehicleSnapshots.GetSnapshot(carIndex));
+	}
+	PublishVehicleSnapshots();
+	m_vehicleSnapshots.AcquireLatest();
 
 	CreateWayPoints();
 
+	//Restarts reset the ranking too, this is the first race so nothing has sized it yet
+	m_raceRanking.Reset((uint)m_numConnectedPlayers);
+
 	SetEnableXInput(true);
 
 	CreateBaseBoxForCollisionDetection();
 
 	LoadTrackMeshesOnSceneCreation();
+
+	if (m_spawnObstacleClusters)
+	{
+		SpawnObstacleClusters();
+	}
+
+	//Respawn poses are checked against the drivable ground, so they wait until the track colliders are in the scene
+	m_respawnPoses.BuildFromCenterline(m_trackCenterline, g_PxPhysXSystem->GetPhysXScene());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -457,6 +507,22 @@ void Game::PerformSingleThreadLoading()
 void Game::LoadTrackMeshesOnSceneCreation()
 {
 	m_trackTestModel = g_renderContext->CreateOrGetMeshFromFile(m_trackTestPath);
+
+	//The colliders mesh makes an actor for every <collision> entry it lists. The merged version is one actor for the whole
+	//track, so we only load a render copy of the mesh alongside it
+	if (m_useMergedTrackCollision)
+	{
+		PxRigidStatic* trackActor = TrackCollisionBaker::CreateMergedTrackActor(TrackCollisionBaker::GetBakedFilePathForMesh(m_trackCollisionsTestPath), &m_tireSurfaces);
+		if (trackActor != nullptr)
+		{
+			g_PxPhysXSystem->GetPhysXScene()->addActor(*trackActor);
+			m_trackCollidersTestModel = g_renderContext->CreateOrGetMeshFromFile(m_trackCollisionsRenderOnlyPath);
+			return;
+		}
+
+		g_devConsole->PrintString(Rgba::ORGANIC_ORANGE, "No baked track collision found, run BakeTrackCollision. Using the collider pieces");
+	}
+
 	m_trackCollidersTestModel = g_renderContext->CreateOrGetMeshFromFile(m_trackCollisionsTestPath);
 }
 
@@ -616,6 +682,133 @@ void Game::UpdateAllCars(float deltaTime)
 	}
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateRaceRanking()
+{
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		Vec3 carPosition = m_cars[carIndex]->GetCarController().GetVehiclePosition();
+		double progress = m_cars[carIndex]->GetWaypoints().GetTrackProgress(carPosition);
+		m_raceRanking.SetCarProgress((uint)carIndex, progress);
+	}
+
+	m_raceRanking.UpdateOrder();
+
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		m_cars[carIndex]->SetRacePosition(m_raceRanking.GetRacePosition((uint)carIndex), m_raceRanking.GetNumCars());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateWaypointsForAllCars()
+{
+	if (m_gateDetectionMode == GATE_DETECTION_TRIGGERS)
+	{
+		DrainGateTriggerEvents(true);
+
+		//Next tick's trigger events are placed inside the tick using the sweep from this position
+		for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+		{
+			Vec3 carPosition = m_cars[carIndex]->GetCarController().GetVehiclePosition();
+			m_cars[carIndex]->GetWaypointsEditable().UpdateSweepOrigin(carPosition);
+		}
+		return;
+	}
+
+	//Triggers still fire in swept mode, throw the events away so the queue doesn't fill up
+	DrainGateTriggerEvents(false);
+
+	//Gather the swept segment and next gate for every car still racing so the whole grid is tested in one pass
+	Vec3 segmentStarts[MAX_GATE_TEST_BATCH];
+	Vec3 segmentEnds[MAX_GATE_TEST_BATCH];
+	uint gateIndices[MAX_GATE_TEST_BATCH];
+	int carIndices[MAX_GATE_TEST_BATCH];
+	uint numSegments = 0;
+
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		WaypointSystem& waypoints = m_cars[carIndex]->GetWaypointsEditable();
+		if (waypoints.AreLapsComplete() || waypoints.GetNumWaypoints() == 0)
+		{
+			continue;
+		}
+
+		Vec3 carPosition = m_cars[carIndex]->GetCarController().GetVehiclePosition();
+
+		segmentStarts[numSegments] = waypoints.BeginGateTest(carPosition);
+		segmentEnds[numSegments] = carPosition;
+		gateIndices[numSegments] = waypoints.GetNextWaypointIndex();
+		carIndices[numSegments] = carIndex;
+		numSegments++;
+	}
+
+	if (numSegments == 0)
+	{
+		return;
+	}
+
+	float entryFractions[MAX_GATE_TEST_BATCH];
+	uint64_t crossedMask = m_trackGates.TestSegmentsAgainstGates(segmentStarts, segmentEnds, gateIndices, numSegments, entryFractions);
+
+	for (uint segmentIndex = 0; segmentIndex < numSegments; segmentIndex++)
+	{
+		bool crossedNextGate = (crossedMask & ((uint64_t)1 << segmentIndex)) != 0;
+		m_cars[carIndices[segmentIndex]]->GetWaypointsEditable().EndGateTest(segmentEnds[segmentIndex], crossedNextGate, entryFractions[segmentIndex]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::DrainGateTriggerEvents(bool applyEvents)
+{
+	GateEventQueue& gateEvents = m_waypointTriggers.GetGateEventQueue();
+
+	GateCrossingEvent gateEvent;
+	while (gateEvents.Pop(gateEvent))
+	{
+		if (applyEvents && gateEvent.m_carIndex < (uint)m_numConnectedPlayers)
+		{
+			Vec3 carPosition = m_cars[gateEvent.m_carIndex]->GetCarController().GetVehiclePosition();
+			m_cars[gateEvent.m_carIndex]->GetWaypointsEditable().HandleGateCrossing(gateEvent.m_gateIndex, carPosition);
+		}
+	}
+
+	uint numDroppedEvents = gateEvents.ConsumeDroppedEventCount();
+	if (numDroppedEvents > 0)
+	{
+		DebuggerPrintf("\n Gate event queue was full, dropped %u events", numDroppedEvents);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SetGateDetectionMode(eGateDetectionMode gateDetectionMode)
+{
+	if (m_gateDetectionMode == gateDetectionMode)
+	{
+		return;
+	}
+
+	m_gateDetectionMode = gateDetectionMode;
+
+	//The cars moved while the other mode was active, don't sweep across that distance
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		m_cars[carIndex]->GetWaypointsEditable().ResetSweepOrigin();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateTriggerCarActors()
+{
+	PxRigidActor* carActors[4];
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		carActors[carIndex] = m_cars[carIndex]->GetCarRigidbody();
+	}
+
+	m_waypointTriggers.SetCarActors(carActors, (uint)m_numConnectedPlayers);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::CheckForRaceCompletion()
 {
@@ -648,6 +841,8 @@ void Game::CheckForRaceCompletion()
 			m_timeBeaten = true;
 		}
 
+		SubmitBestSplitsForRun();
+
 		HandleRaceCompletedCondition();
 
 		CheckXInputForRestart();
@@ -676,57 +871,22 @@ void Game::CreatePhysXVehicleBoxWall()
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::CreateObstacleWall(const int numHorizontalBoxes, const int numVerticalBoxes, const float boxSize, const PxVec3& pos, const PxQuat& quat)
 {
-	const PxF32 density = 50.0f;
+	std::vector<PxRigidDynamic*> bricks;
+	ObstacleClusterBuilder::BuildWall(bricks, numHorizontalBoxes, numVerticalBoxes, boxSize, pos, quat, *g_PxPhysXSystem->GetDefaultPxMaterial());
 
-	const PxF32 sizeX = boxSize;
-	const PxF32 sizeY = boxSize;
-	const PxF32 sizeZ = boxSize;
-
-	const PxF32 mass = sizeX * sizeY*sizeZ*density;
-	const PxVec3 halfExtents(sizeX*0.5f, sizeY*0.5f, sizeZ*0.5f);
-	PxBoxGeometry geometry(halfExtents);
-	PxTransform shapeTransforms[1] = { PxTransform(PxIdentity) };
-	PxGeometry* shapeGeometries[1] = { &geometry };
-	PxMaterial* shapeMaterials[1] = { g_PxPhysXSystem->GetDefaultPxMaterial() };
-
-	const PxF32 spacing = 0.0001f;
-	PxVec3 relPos(0.0f, sizeY / 2, 0.0f);
-	PxF32 offsetX = -(numHorizontalBoxes * (sizeX + spacing) * 0.5f);
-	PxF32 offsetZ = 0.0f;
-
-	for (PxU32 k = 0; k < (PxU32)numVerticalBoxes; k++)
-	{
-		for (PxU32 i = 0; i < (PxU32)numHorizontalBoxes; i++)
-		{
-			relPos.x = offsetX + (sizeX + spacing)*i;
-			relPos.z = offsetZ;
-			PxTransform transform(pos + quat.rotate(relPos), quat);
-			g_PxPhysXSystem->AddDynamicObstacle(transform, mass, 1, shapeTransforms, shapeGeometries, shapeMaterials);
-		}
-
-		if (0 == (k % 2))
-		{
-			offsetX += sizeX / 2;
-		}
-		else
-		{
-			offsetX -= sizeX / 2;
-		}
-		relPos.y += (sizeY + spacing);
-	}
+	ObstacleClusterBuilder::InsertCluster(*g_PxPhysXSystem->GetPhysXScene(), bricks.data(), (uint)bricks.size(), m_obstacleInsertMode);
+	m_obstacleActivation.AddRegion(bricks.data(), (uint)bricks.size());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::CreatePhysXVehicleRamp()
 {
-	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
-	PxCooking* pxCooking = g_PxPhysXSystem->GetPhysXCookingModule();
 	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
 
 	//Add a really big ramp to jump over 
 	{
 		PxVec3 halfExtentsRamp(5.0f, 1.9f, 7.0f);
-		PxConvexMeshGeometry geomRamp(g_PxPhysXSystem->CreateWedgeConvexMesh(halfExtentsRamp, *physX, *pxCooking));
+		PxConvexMeshGeometry geomRamp(CookedMeshCache::CreateWedgeConvexMesh(halfExtentsRamp));
 		PxTransform shapeTransforms[1] = { PxTransform(PxIdentity) };
 		PxMaterial* shapeMaterials[1] = { pxMaterial };
 		PxGeometry* shapeGeometries[1] = { &geomRamp };
@@ -743,7 +903,7 @@ void Game::CreatePhysXVehicleRamp()
 	//Add two ramps side by side somewhere
 	{
 		PxVec3 halfExtents(3.0f, 1.5f, 3.5f);
-		PxConvexMeshGeometry geometry(g_PxPhysXSystem->CreateWedgeConvexMesh(halfExtents, *physX, *pxCooking));
+		PxConvexMeshGeometry geometry(CookedMeshCache::CreateWedgeConvexMesh(halfExtents));
 		PxTransform shapeTransforms[1] = { PxTransform(PxIdentity) };
 		PxMaterial* shapeMaterials[1] = { pxMaterial };
 		PxGeometry* shapeGeometries[1] = { &geometry };
@@ -779,6 +939,9 @@ void Game::CreatePhysXVehicleObstacles()
 
 	pxScene->addActor(*rs);
 
+	std::vector<PxRigidDynamic*> planks;
+	planks.reserve(64);
+
 	for (PxU32 i = 0; i < 64; i++)
 	{
 		t = PxTransform(PxVec3(20.f + i * 0.01f, 2.0f + i * 0.25f, 20.0f + i * 0.025f), PxQuat(PxPi*0.5f, PxVec3(0, 1, 0)));
@@ -793,9 +956,12 @@ void Game::CreatePhysXVehicleObstacles()
 		shape->setQueryFilterData(qryFilterData);
 
 		PxRigidBodyExt::updateMassAndInertia(*rd, 30.0f);
-
-		pxScene->addActor(*rd);
+		planks.push_back(rd);
 	}
+
+	//The planks start piled on top of each other, so they keep self collision inside their aggregate
+	ObstacleClusterBuilder::InsertCluster(*pxScene, planks.data(), (uint)planks.size(), m_obstacleInsertMode);
+	m_obstacleActivation.AddRegion(planks.data(), (uint)planks.size());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -827,27 +993,20 @@ void Game::CreatePhysXStack(const Vec3& position, uint size, float halfExtent)
 	PxScene* pxScene = g_PxPhysXSystem->GetPhysXScene();
 
 	PxTransform pxTransform = PxTransform(PxVec3(position.x, position.y, position.z));
-
-	//We are going to make a stack of boxes
-	PxBoxGeometry box = PxBoxGeometry((PxReal)halfExtent, (PxReal)halfExtent, (PxReal)halfExtent);
 	PxMaterial* pxMaterial = physX->createMaterial(0.5f, 0.5f, 0.6f);
-	PxShape* shape = physX->createShape(box, *pxMaterial);
-	
-	//Loop to stack everything in a pyramid shape
-	for (PxU32 layerIndex = 0; layerIndex < size; layerIndex++)
-	{
-		for (PxU32 indexInLayer = 0; indexInLayer < size - layerIndex; indexInLayer++)
-		{
-			PxTransform localTm(PxVec3(PxReal(indexInLayer * 2) - PxReal(size - layerIndex), PxReal(layerIndex * 2 + 1), 0) * halfExtent);
-			PxRigidDynamic* body = physX->createRigidDynamic(pxTransform.transform(localTm));
-			body->attachShape(*shape);
-			PxRigidBodyExt::updateMassAndInertia(*body, 10.0f);
-			pxScene->addActor(*body);
-		}
-	}
 
-	//release the shape now, we don't need it anymore since everything has been added to the PhysX scene
-	shape->release();
+	std::vector<PxRigidDynamic*> boxes;
+	ObstacleClusterBuilder::BuildPyramid(boxes, pxTransform, size, halfExtent, *pxMaterial);
+
+	ObstacleClusterBuilder::InsertCluster(*pxScene, boxes.data(), (uint)boxes.size(), m_obstacleInsertMode);
+	m_obstacleActivation.AddRegion(boxes.data(), (uint)boxes.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SpawnObstacleClusters()
+{
+	CreatePhysXVehicleBoxWall();
+	CreatePhysXStack(Vec3(-30.f, 0.f, 10.f), 8, 0.5f);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -859,6 +1018,13 @@ void Game::ResetCarPositionForPlayer(int playerID)
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::HandleKeyPressed(unsigned char keyCode)
 {
+	//Key handling can spawn objects, reset cars and run console commands, none of which can overlap a physics tick
+	std::unique_lock<std::mutex> simulationLock(m_simulationLock, std::defer_lock);
+	if (IsPhysicsThreaded())
+	{
+		simulationLock.lock();
+	}
+
 	if(g_devConsole->IsOpen())
 	{
 		g_devConsole->HandleKeyDown(keyCode);
@@ -1003,6 +1169,11 @@ void Game::HandleKeyPressed(unsigned char keyCode)
 			}
 			break;
 		}
+		case NUM_5:
+		{
+			m_debugRenderWaypoints = !m_debugRenderWaypoints;
+			break;
+		}
 		case ENTER_KEY:
 		{
 			if (!m_initiateFromMenu)
@@ -1038,6 +1209,8 @@ void Game::Shutdown()
 
 	DeleteUI();
 
+	ShutdownSimulation();
+
 	for (int i = 0; i < m_numConnectedPlayers; i++)
 	{
 		m_cars[i]->Shutdown();
@@ -1088,6 +1261,12 @@ void Game::Shutdown()
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::HandleKeyReleased(unsigned char keyCode)
 {
+	std::unique_lock<std::mutex> simulationLock(m_simulationLock, std::defer_lock);
+	if (IsPhysicsThreaded())
+	{
+		simulationLock.lock();
+	}
+
 	if(g_devConsole->IsOpen())
 	{
 		g_devConsole->HandleKeyUp(keyCode);
@@ -1269,60 +1448,42 @@ void Game::RenderPhysXScene() const
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Game::RenderPhysXCar(const CarController& carController) const
+void Game::RenderPhysXCar(const Car& car) const
 {
-	//Draw a maximum of 10 shapes
-	PxShape* shapes[10] = { nullptr };
-	CPUMesh carMesh;
-	CPUMesh cvxMesh;
+	//Everything here comes from the published snapshot so it is safe to draw while physics steps on another thread
+	const VehicleStateSnapshot& snapshot = car.GetVehicleSnapshot();
+	if (!snapshot.m_isValid)
+	{
+		return;
+	}
+
 	Matrix44 model;
 
-	PxRigidActor *car = carController.GetVehicle()->getRigidDynamicActor();
-	int numShapes = car->getNbShapes();
-	car->getShapes(shapes, numShapes);
+	//Draw where the car is between the last two physics ticks so it moves smoothly at any render rate
+	PxTransform carPose = snapshot.GetInterpolatedActorPose(m_fixedStepAlpha);
+	int numShapes = snapshot.m_current.m_numShapes;
 
 	//The car and wheel use the same material so only need to bind this once
 	g_renderContext->BindMaterial(g_renderContext->CreateOrGetMaterialFromFile(m_wheelModel->GetDefaultMaterialName()));
 
 	for (int shapeIndex = 0; shapeIndex < numShapes; shapeIndex++)
 	{
-		PxConvexMeshGeometry geometry;
-		shapes[shapeIndex]->getConvexMeshGeometry(geometry);
-
-		PxMat44 pxMat = car->getGlobalPose() * shapes[shapeIndex]->getLocalPose();
+		PxMat44 pxMat = PxMat44(carPose * snapshot.GetInterpolatedShapePose(shapeIndex, m_fixedStepAlpha));
 
 		model.SetIBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column0));
 		model.SetJBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column1));
 		model.SetKBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column2));
 		model.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column3));
 
-		if (geometry.convexMesh->getNbVertices() == 8)
+		if (shapeIndex == snapshot.m_current.m_chassisShapeIndex)
 		{
-			//This is the car because we know the car mesh is basically a box (8 verts)
+			//Chassis offset so the body mesh sits over the collision box
 			Vec4 forwardOffsetVec4 = model.GetKBasis4() * 0.3f;
 			model.SetTBasis(g_PxPhysXSystem->PxVectorToVec(pxMat.column3) + m_offsetCarBody + forwardOffsetVec4);
 
-			g_renderContext->SetModelMatrix(model);
-
 			//Draw the car mesh
 			g_renderContext->SetModelMatrix(model);
 			g_renderContext->DrawMesh(m_carModel);
-
-			if (m_debugViewCarCollider)
-			{
-				Matrix44 modelMatrix = Matrix44::IDENTITY;
-				//modelMatrix.SetTranslation3D(Vec3(0.f, 100.f, 0.f), modelMatrix);
-				g_renderContext->SetModelMatrix(modelMatrix);
-				g_renderContext->BindMaterial(m_defaultMaterial);
-				AddMeshForConvexMesh(cvxMesh, *car, *shapes[shapeIndex], Rgba::MAGENTA);
-				GPUMesh debugMesh(g_renderContext);
-				debugMesh.CreateFromCPUMesh<Vertex_Lit>(&cvxMesh);
-				g_renderContext->DrawMesh(&debugMesh);
-			}
-		
-			Rgba color = Rgba(1.f, 1.f, 1.f, 1.f);
-			int numCarShapes = car->getNbShapes();;
-			std::vector<PxShape*> carShapes(numCarShapes);
 		}
 		else
 		{
@@ -1335,21 +1496,40 @@ void Game::RenderPhysXCar(const CarController& carController) const
 			{
 				g_renderContext->DrawMesh(m_wheelModel);
 			}
+		}
+	}
 
-			if (m_debugViewCarCollider)
-			{	
-				Matrix44 modelMatrix = Matrix44::IDENTITY;
-				g_renderContext->SetModelMatrix(modelMatrix);
-				AddMeshForConvexMesh(cvxMesh, *car, *shapes[shapeIndex], Rgba::MAGENTA);
-				GPUMesh debugMesh(g_renderContext);
-				debugMesh.CreateFromCPUMesh<Vertex_Lit>(&cvxMesh);
-				g_renderContext->DrawMesh(&debugMesh);
-			}
+	if (m_debugViewCarCollider)
+	{
+		RenderPhysXCarColliders(car.GetCarController());
+	}
+}
 
-		}
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::RenderPhysXCarColliders(const CarController& carController) const
+{
+	//Debug only, reads the live PhysX shapes so it has to wait for the physics tick to finish
+	std::unique_lock<std::mutex> simulationLock(m_simulationLock, std::defer_lock);
+	if (IsPhysicsThreaded())
+	{
+		simulationLock.lock();
 	}
 
-	
+	PxShape* shapes[MAX_INTERPOLATED_SHAPES] = { nullptr };
+	PxRigidActor* car = carController.GetVehicle()->getRigidDynamicActor();
+	int numShapes = (int)car->getShapes(shapes, MAX_INTERPOLATED_SHAPES);
+
+	g_renderContext->SetModelMatrix(Matrix44::IDENTITY);
+	g_renderContext->BindMaterial(m_defaultMaterial);
+
+	for (int shapeIndex = 0; shapeIndex < numShapes; shapeIndex++)
+	{
+		CPUMesh cvxMesh;
+		AddMeshForConvexMesh(cvxMesh, *car, *shapes[shapeIndex], Rgba::MAGENTA);
+		GPUMesh debugMesh(g_renderContext);
+		debugMesh.CreateFromCPUMesh<Vertex_Lit>(&cvxMesh);
+		g_renderContext->DrawMesh(&debugMesh);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -1727,6 +1907,14 @@ void Game::RenderDebugInfoOnScreen() const
 	textVerts.clear();
 	m_menuFont->AddVertsForText2D(textVerts, displayArea, m_fontHeight, printString, Rgba::WHITE);
 	g_renderContext->DrawVertexArray(textVerts);
+
+	displayArea.y -= m_fontHeight;
+
+	//Time spent waiting for an overlapped physics step, 0 means render covered the whole step
+	printString = Stringf("Physics Wait: %.3f ms", m_physicsWaitTimeSeconds * 1000.0);
+	textVerts.clear();
+	m_menuFont->AddVertsForText2D(textVerts, displayArea, m_fontHeight, printString, Rgba::WHITE);
+	g_renderContext->DrawVertexArray(textVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -1829,6 +2017,8 @@ void Game::RestartLevel()
 		
 		SetEnableXInput(true);
 	}
+
+	m_raceRanking.Reset((uint)m_numConnectedPlayers);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -1917,25 +2107,37 @@ void Game::CreateBaseBoxForCollisionDetection()
 	setupDrivableSurface(qryFilterData);
 	shape->setQueryFilterData(qryFilterData);
 
+	//This box is the ground the cars drive on wherever there's no track piece, so it carries the configured surface
+	m_tireSurfaces.ApplySurfaceToShape(*shape, m_groundSurface);
+
 	pxScene->addActor(*rs);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::ResetCarsUsingToolData()
 {
-	//Use tool data and re-create car controllers
+	//Tuning goes into the live vehicles. Only new chassis or wheel dimensions need new vehicles, and those keep their pose and speed
+	bool rebuildVehicles = m_carTool.HasVehicleGeometryChanged();
 
 	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
 	{
 		CarController* controller = m_cars[carIndex]->GetCarControllerEditable();
-		//Vec3 carPosition = controller->GetVehiclePosition();
 
-		//Remove actor from scene
-		controller->RemoveVehicleFromScene();
+		if (rebuildVehicles)
+		{
+			controller->ReplacePxVehicle(m_carTool.MakeNewCar());
+		}
+		else
+		{
+			m_carTool.ApplyToVehicle(*controller->GetVehicle());
+		}
+	}
 
-		//Make a new car using the data from tool
-		controller->SetNewPxVehicle(m_carTool.MakeNewCar());
-		//controller->SetVehiclePosition(carPosition);
+	if (rebuildVehicles)
+	{
+		//The trigger lookup is keyed on actor address and those just changed
+		UpdateTriggerCarActors();
+		m_raceRanking.Reset((uint)m_numConnectedPlayers);
 	}
 }
 
@@ -1977,6 +2179,26 @@ void Game::ReadBestTimeFromTextFile()
 	m_bestTimeFromFile = atof(buffer);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SubmitBestSplitsForRun()
+{
+	//Only rewrite the file when some car's best lap beat the stored one
+	bool splitsChanged = false;
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		const WaypointSystem& waypoints = m_cars[carIndex]->GetWaypoints();
+		if (m_bestSplits.SubmitLapIfFaster(waypoints.GetBestLapSplits(), waypoints.GetNumBestLapSplits()))
+		{
+			splitsChanged = true;
+		}
+	}
+
+	if (splitsChanged)
+	{
+		m_bestSplits.SaveToTextFile(m_bestSplitsFilePath);
+	}
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::SetMeshesAndJoinThreads()
 {
@@ -2039,9 +2261,15 @@ void Game::RenderSceneForCarCameras() const
 		g_renderContext->SetModelMatrix(Matrix44::IDENTITY);
 		m_cars[carIndex]->GetWaypoints().RenderNextWaypoint();
 
+		if (m_debugRenderWaypoints)
+		{
+			m_cars[carIndex]->GetWaypoints().DebugRenderWaypoints();
+			m_trackCenterline.DebugRenderCenterline();
+		}
+
 		for (int renderCarIndex = 0; renderCarIndex < m_numConnectedPlayers; renderCarIndex++)
 		{
-			RenderPhysXCar(m_cars[renderCarIndex]->GetCarController());
+			RenderPhysXCar(*m_cars[renderCarIndex]);
 		}
 
 		g_renderContext->EndCamera();
@@ -2069,7 +2297,7 @@ void Game::RenderScreenForMainCamera() const
 
 	for (int renderCarIndex = 0; renderCarIndex < m_numConnectedPlayers; renderCarIndex++)
 	{
-		RenderPhysXCar(m_cars[renderCarIndex]->GetCarController());
+		RenderPhysXCar(*m_cars[renderCarIndex]);
 	}
 
 	g_renderContext->EndCamera();
@@ -2454,6 +2682,21 @@ void Game::CheckForGameStart()
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::Update(float deltaTime)
 {
+	//With physics on its own thread the whole update runs between ticks, never during one
+	std::unique_lock<std::mutex> simulationLock(m_simulationLock, std::defer_lock);
+	if (IsPhysicsThreaded())
+	{
+		simulationLock.lock();
+	}
+
+	//Everything below and the next Render read the vehicles from this copy
+	m_vehicleSnapshots.AcquireLatest();
+	if (IsPhysicsThreaded())
+	{
+		double timeSincePublish = GetCurrentTimeSeconds() - m_vehicleSnapshots.GetPublishTime();
+		SetFixedStepAlpha((float)(timeSincePublish / m_physicsThread.GetFixedTimeStep()));
+	}
+
 	if (m_numConnectedPlayers == 0)
 		return;	//Currently unsupported for keyboard input
 
@@ -2495,6 +2738,9 @@ void Game::Update(float deltaTime)
 		UpdateImGUI();
 	}
 
+	//Cameras follow the interpolated car so they run every render frame instead of every physics tick
+	UpdateCarCamera(deltaTime);
+
 	UpdateAllCars(deltaTime);
 	CheckForRaceCompletion();
 }
@@ -2502,8 +2748,37 @@ void Game::Update(float deltaTime)
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::FixedUpdate(float deltaTime)
 {
-	UpdateCarCamera(deltaTime);
+	if (m_threadedLoadComplete)
+	{
+		//Race time only moves with physics ticks so lap times don't depend on the render frame rate.
+		//The physics step for this tick has already run so gate checks look at where the cars ended up
+		m_raceClock.AdvanceTick(deltaTime);
+		UpdateWaypointsForAllCars();
+		UpdateRaceRanking();
+	}
+
 	UpdatePhysXCar(deltaTime);
+	UpdateObstacleActivation();
+	PublishVehicleSnapshots();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::UpdateObstacleActivation()
+{
+	if (!m_threadedLoadComplete)
+	{
+		return;
+	}
+
+	//Runs between scene steps, so the flag changes land before the next simulate
+	PxVec3 carPositions[MAX_SNAPSHOT_CARS];
+	uint numCars = 0;
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers && numCars < MAX_SNAPSHOT_CARS; carIndex++)
+	{
+		carPositions[numCars++] = m_cars[carIndex]->GetCarRigidbody()->getGlobalPose().p;
+	}
+
+	m_obstacleActivation.UpdateActivation(carPositions, numCars);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -2514,11 +2789,84 @@ void Game::UpdatePhysXCar(float deltaTime)
 		return;
 	}
 
+	//Inputs go on each car first, then every vehicle is stepped together
+	PxVehicleWheels* vehicles[MAX_MANAGED_VEHICLES];
+	uint numVehicles = 0;
+
 	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
 	{
 		m_cars[carIndex]->FixedUpdate(deltaTime);
+		vehicles[numVehicles++] = m_cars[carIndex]->GetCarController().GetVehicle();
+	}
+
+	m_vehicleManager.UpdateVehicles(deltaTime, vehicles, numVehicles);
+
+	//Both the scene step and the vehicle update for this tick are done, keep the result to blend towards when rendering.
+	//Car i went in as vehicle i, so its wheel query results are in slot i
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+	{
+		m_cars[carIndex]->GetCarControllerEditable()->RecordPhysicsState(&m_vehicleManager.GetVehicleQueryResult(carIndex), deltaTime);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::PublishVehicleSnapshots()
+{
+	if (!m_threadedLoadComplete)
+	{
+		return;
 	}
 
+	VehicleStateSnapshot snapshots[MAX_SNAPSHOT_CARS];
+	uint numCars = 0;
+	for (int carIndex = 0; carIndex < m_numConnectedPlayers && numCars < MAX_SNAPSHOT_CARS; carIndex++)
+	{
+		snapshots[numCars++] = m_cars[carIndex]->GetCarController().GetStateSnapshot();
+	}
+
+	m_vehicleSnapshots.Publish(snapshots, numCars, GetCurrentTimeSeconds());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StartPhysicsThread(double fixedTimeStep, int maxTicksBehind)
+{
+	m_physicsThread.Start(this, fixedTimeStep, maxTicksBehind, &m_simulationLock);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::StopPhysicsThread()
+{
+	m_physicsThread.Stop();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Game::IsPhysicsThreaded() const
+{
+	return m_physicsThread.IsRunning();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::ShutdownSimulation()
+{
+	//The thread has to be gone before anything it touches is released
+	StopPhysicsThread();
+	m_vehicleManager.Shutdown();
+	m_waypointTriggers.DestroyTriggers();
+	m_obstacleActivation.Clear();
+	m_vehicleManager.SetTireFrictionPairs(nullptr);
+	m_tireSurfaces.Shutdown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SetFixedStepAlpha(float fixedStepAlpha)
+{
+	m_fixedStepAlpha = Clamp(fixedStepAlpha, 0.f, 1.f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Game::SetPhysicsWaitTime(double waitTimeSeconds)
+{
+	m_physicsWaitTimeSeconds = waitTimeSeconds;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -2526,7 +2874,7 @@ void Game::UpdateCarCamera(float deltaTime)
 {
 	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
 	{
-		m_cars[carIndex]->UpdateCarCamera(deltaTime);
+		m_cars[carIndex]->UpdateCarCamera(deltaTime, m_fixedStepAlpha);
 	}
 }
 
@@ -2617,6 +2965,10 @@ void Game::UpdateImGUIDebugWidget()
 	ImGui::Checkbox("Enable Convex Hull Debug", &ui_enableConvexHullRenders);
 	ImGui::Checkbox("Enable Car Debug", &ui_enableCarDebug);
 
+	bool useTriggerGates = (m_gateDetectionMode == GATE_DETECTION_TRIGGERS);
+	ImGui::Checkbox("Use Trigger Gates", &useTriggerGates);
+	SetGateDetectionMode(useTriggerGates ? GATE_DETECTION_TRIGGERS : GATE_DETECTION_SWEPT);
+
 	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
 	m_directionalLightPos.x = ui_dirLight[0];
@@ -2634,17 +2986,29 @@ void Game::UpdateImGUIDebugWidget()
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::UpdateImGUIVehicleTool()
 {
-	m_carTool.UpdateImGUICarTool();
+	m_carTool.UpdateImGUICarTool(m_vehicleManager);
+
+	//Sub-steps are per vehicle, so slider changes go into each live car rather than waiting for a reset
+	if (m_carTool.ConsumeSubStepSettingsChanged())
+	{
+		for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
+		{
+			m_carTool.ApplySubStepsToVehicle(*m_cars[carIndex]->GetCarController().GetVehicle());
+		}
+	}
 
 	ImGui::Begin("Reset Cars using Tool data");
 
-	bool result = ImGui::Button("Click To Reset Cars");
+	bool result = ImGui::Button("Click To Apply To Cars");
 	if (result)
 	{
-		//Create new cars here
-		DebuggerPrintf("\n Creating new cars");
 		ResetCarsUsingToolData();
 	}
+
+	if (m_carTool.HasVehicleGeometryChanged())
+	{
+		ImGui::Text("Chassis or wheel dimensions changed, cars will be rebuilt");
+	}
 	
 
 	ImGui::End();
@@ -2668,7 +3032,7 @@ void Game::RenderGearNumber(int carIndex) const
 	g_renderContext->BindTextureViewWithSampler(0U, m_menuFont->GetTexture());
 	g_renderContext->BindShader(m_shader);
 	std::vector<Vertex_PCU> verts;
-	std::string textValue = std::to_string(m_cars[carIndex]->GetCarController().GetVehicle()->mDriveDynData.getCurrentGear());
+	std::string textValue = std::to_string(m_cars[carIndex]->GetVehicleSnapshot().m_current.m_currentGear);
 	m_menuFont->AddVertsForText2D(verts, Vec2((HUD.GetOrthoTopRight().x * 0.5f) + 50.f * carIndex, 100.f), 10.f, textValue.c_str(), Rgba::RED);
 	g_renderContext->DrawVertexArray(verts);
 
@@ -2678,16 +3042,27 @@ void Game::RenderGearNumber(int carIndex) const
 //------------------------------------------------------------------------------------------------------------------------------
 void Game::CreateWayPoints()
 {
+	//The gates are loaded once for the track and every car reads from the same table
+	if (!m_trackGates.LoadFromXMLFile(m_trackGatesPath))
+	{
+		ERROR_AND_DIE(">> Error loading track gates ");
+	}
+
+	m_waypointTriggers.CreateTriggersForGates(m_trackGates);
+	m_trackCenterline.BuildFromGates(m_trackGates);
+
 	for (int carIndex = 0; carIndex < m_numConnectedPlayers; carIndex++)
 	{
 		WaypointSystem& waypoints = m_cars[carIndex]->GetWaypointsEditable(); 
+		waypoints.SetTrackGates(&m_trackGates);
+		waypoints.SetBestSplits(&m_bestSplits);
+		waypoints.SetRaceClock(&m_raceClock);
 		waypoints.Startup();
 
-		for (int waypointIndex = 0; waypointIndex < 5; waypointIndex++)
-		{
-			waypoints.AddNewWayPoint(m_wayPointPositions[waypointIndex], m_wayPointHalfExtents[waypointIndex], waypointIndex);
-		}
+		m_cars[carIndex]->SetRespawnPoses(&m_respawnPoses);
 	}
+
+	UpdateTriggerCarActors();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
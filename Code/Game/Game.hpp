@@ -15,10 +15,21 @@
 #include "Game/WaypointTriggerBased.hpp"
 #include "Game/WaypointRegionBased.hpp"
 #include "Game/WaypointSystem.hpp"
+#include "Game/TrackGateTable.hpp"
+#include "Game/TrackSplitTable.hpp"
+#include "Game/RaceRanking.hpp"
+#include "Game/RaceClock.hpp"
+#include "Game/TrackCenterline.hpp"
 #include "Game/SplitScreenSystem.hpp"
 #include "Game/Car.hpp"
 #include "Game/GameplayWork.hpp"
 #include "Game/CarTool.hpp"
+#include "Game/VehicleManager.hpp"
+#include "Game/VehicleStateSnapshot.hpp"
+#include "Game/PhysicsThread.hpp"
+#include "Game/ObstacleActivationManager.hpp"
+#include "Game/ObstacleClusterBuilder.hpp"
+#include "Game/TireSurfaceTable.hpp"
 //Third Party
 #include "extensions/PxDefaultAllocator.h"
 #include "extensions/PxDefaultCpuDispatcher.h"
@@ -59,6 +70,21 @@ public:
 	void								Shutdown();
 	void								Update(float deltaTime);
 	void								FixedUpdate(float deltaTime);
+
+	//How far the current render frame is between the last two physics ticks, set by App before Update
+	void								SetFixedStepAlpha(float fixedStepAlpha);
+
+	//Time App spent in fetchResults for the last overlapped step, shown on the perf HUD
+	void								SetPhysicsWaitTime(double waitTimeSeconds);
+
+	//Physics on its own thread. While it runs, Update and key handling hold the simulation lock and the fixed step alpha
+	//comes from the time since the last published snapshot instead of from App
+	void								StartPhysicsThread(double fixedTimeStep, int maxTicksBehind);
+	void								StopPhysicsThread();
+	bool								IsPhysicsThreaded() const;
+
+	//Releases everything that holds on to PhysX objects. App calls this before PhysX is destroyed, safe to call more than once
+	void								ShutdownSimulation();
 	void								UpdateImGUI();
 
 	//For Audio setup reusing existing audio IDs
@@ -83,6 +109,10 @@ public:
 
 	void								CreatePhysXConvexHull();
 	void								CreatePhysXStack(const Vec3& position, uint size, float halfExtent);
+
+	//The brick wall and box stack, only when spawnObstacleClusters is on in the game config. Both register with the
+	//obstacle activation manager
+	void								SpawnObstacleClusters();
 	
 	//Vehicle Reset
 	void								ResetCarPositionForPlayer(int playerID);
@@ -102,6 +132,8 @@ public:
 	void								PerformFPSCachingAndCalculation(float deltaTime);
 	void								CheckForGameStart();
 	void								UpdatePhysXCar(float deltaTime);
+	void								UpdateObstacleActivation();
+	void								PublishVehicleSnapshots();
 	void								UpdateCarCamera(float deltaTime);
 	
 	void								UpdateImGUIPhysXWidget();
@@ -136,6 +168,7 @@ private:
 	void								ResetCarsUsingToolData();
 	void								ReadBestTimeFromFile();
 	void								ReadBestTimeFromTextFile();
+	void								SubmitBestSplitsForRun();
 
 	//Async Functionality 
 	void								PerformAsyncLoading();
@@ -153,6 +186,11 @@ private:
 
 	//Update Functions
 	void								UpdateAllCars(float deltaTime);
+	void								UpdateWaypointsForAllCars();
+	void								UpdateRaceRanking();
+	void								DrainGateTriggerEvents(bool applyEvents);
+	void								SetGateDetectionMode(eGateDetectionMode gateDetectionMode);
+	void								UpdateTriggerCarActors();
 	void								CheckForRaceCompletion();
 
 	void								HandleRaceCompletedCondition();
@@ -180,7 +218,8 @@ private:
 	void								RenderScreenForMainCamera() const;
 
 	void								RenderPhysXScene() const;
-	void								RenderPhysXCar(const CarController& carController) const;
+	void								RenderPhysXCar(const Car& car) const;
+	void								RenderPhysXCarColliders(const CarController& carController) const;
 	void								RenderPhysXActors(const std::vector<PxRigidActor*> actors, int numActors, Rgba& color) const;
 
 	void								RenderViewportBorders() const;
@@ -226,6 +265,7 @@ private:
 
 	float								m_fpsLowest = 10.f;
 	float								m_fpsHighest = 0.f;
+	double								m_physicsWaitTimeSeconds = 0.0;
 
 	Car*								m_cars[4] = {nullptr, nullptr, nullptr, nullptr};
 	Vec3								m_startPositions[4] = { 
@@ -260,6 +300,13 @@ public:
 	std::vector<std::thread>			m_threads;
 	bool								m_threadedLoadComplete = false;
 
+	float								m_fixedStepAlpha = 1.f;
+
+	//Physics thread and the data it shares with the main thread
+	PhysicsThread						m_physicsThread;
+	mutable std::mutex					m_simulationLock;
+	VehicleSnapshotBuffer				m_vehicleSnapshots;
+
 	//Image Paths
 	std::string							m_testImagePath = "Test_StbiFlippedAndOpenGL.png";
 	std::string							m_boxTexturePath = "woodcrate.jpg";
@@ -284,6 +331,10 @@ public:
 	std::string							m_trackJumpPath = "Track/jump1.mesh";
 	std::string							m_trackTestPath = "ScaledTrack/ScaledTrack1RoadOnly.mesh";
 	std::string							m_trackCollisionsTestPath = "ScaledTrack/ScaledTrack1CollidersOnly.mesh";
+	std::string							m_trackCollisionsRenderOnlyPath = "ScaledTrack/ScaledTrack1CollidersRenderOnly.mesh";
+	bool								m_useMergedTrackCollision = false;	//Baked with the BakeTrackCollision console command
+	bool								m_spawnObstacleClusters = false;
+	eClusterInsertMode					m_obstacleInsertMode = CLUSTER_INSERT_AGGREGATE;	//How the spawned clusters go into the scene
 
 	Camera*								m_mainCamera = nullptr;
 	Camera*								m_devConsoleCamera = nullptr;
@@ -410,18 +461,6 @@ public:
 
 	bool								m_debugViewCarCollider = false;
 
-	Vec3								m_wayPointPositions[5] = { Vec3(22.5f, 0.f, 10.f),
-																	Vec3(65.f, 0.f, 126.5f),
-																	Vec3(-55.5f, 0.f, 65.f), 
-																	Vec3(-37.5f, 0.f, -50.f), 
-																	Vec3(67.5f, 0.f, -75.f) };
-
-	Vec3								m_wayPointHalfExtents[5] = { Vec3(6.5f, 5.f, 1.f),
-																	Vec3(1.f, 5.f, 6.5f),
-																	Vec3(8.5f, 5.f, 1.f),
-																	Vec3(6.5f, 5.f, 1.f),
-																	Vec3(6.5f, 5.f, 1.f) };
-
 	//------------------------------------------------------------------------------------------------------------------------------
 	//Car Camera and other game data
 	//------------------------------------------------------------------------------------------------------------------------------
@@ -433,6 +472,19 @@ public:
 	//------------------------------------------------------------------------------------------------------------------------------
 	// Waypoint System
 	//------------------------------------------------------------------------------------------------------------------------------
+	TrackGateTable						m_trackGates;
+	std::string							m_trackGatesPath = "Data/Gameplay/TrackGates.xml";
+	WaypointTriggerBased				m_waypointTriggers;
+	eGateDetectionMode					m_gateDetectionMode = DEFAULT_GATE_DETECTION;
+	RaceRanking							m_raceRanking;
+	RaceClock							m_raceClock;
+	VehicleManager						m_vehicleManager;
+	TireSurfaceTable					m_tireSurfaces;
+	std::string							m_tireSurfacesPath = "Data/Gameplay/TireSurfaces.xml";
+	eTireSurface						m_groundSurface = TIRE_SURFACE_ROAD;	//The base box, which is what the cars drive on off the track pieces
+	ObstacleActivationManager			m_obstacleActivation;
+	TrackCenterline						m_trackCenterline;
+	TrackRespawnPoses					m_respawnPoses;
 	bool								m_debugRenderWaypoints = false;
 	bool								m_debugPerfEnabled = false;
 	//Save File data
@@ -441,6 +493,8 @@ public:
 	double								m_previousBestTime = 0.0;
 	std::string							m_saveFilePath = "Data/Gameplay/SaveFile.xml";
 	std::string							m_saveFileTextPath = "Data/Gameplay/BestTime.txt";
+	std::string							m_bestSplitsFilePath = "Data/Gameplay/BestSplits.txt";
+	TrackSplitTable						m_bestSplits;
 	bool								m_timeBeaten = false;
 
 	//------------------------------------------------------------------------------------------------------------------------------
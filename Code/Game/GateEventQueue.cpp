@@ -0,0 +1,56 @@
+#include "Game/GateEventQueue.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+GateEventQueue::GateEventQueue()
+	: m_writeIndex(0)
+	, m_readIndex(0)
+	, m_numDroppedEvents(0)
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+GateEventQueue::~GateEventQueue()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool GateEventQueue::Push(const GateCrossingEvent& gateEvent)
+{
+	uint writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+	uint readIndex = m_readIndex.load(std::memory_order_acquire);
+
+	//Indices only ever increase and wrap on their own, the difference is the number of queued events
+	if (writeIndex - readIndex >= GATE_EVENT_QUEUE_CAPACITY)
+	{
+		m_numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_events[writeIndex & (GATE_EVENT_QUEUE_CAPACITY - 1)] = gateEvent;
+	m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool GateEventQueue::Pop(GateCrossingEvent& outGateEvent)
+{
+	uint readIndex = m_readIndex.load(std::memory_order_relaxed);
+	uint writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+	if (readIndex == writeIndex)
+	{
+		return false;
+	}
+
+	outGateEvent = m_events[readIndex & (GATE_EVENT_QUEUE_CAPACITY - 1)];
+	m_readIndex.store(readIndex + 1, std::memory_order_release);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint GateEventQueue::ConsumeDroppedEventCount()
+{
+	return m_numDroppedEvents.exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,43 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <atomic>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Must be a power of 2 so the ring index is a mask instead of a modulo
+constexpr uint GATE_EVENT_QUEUE_CAPACITY = 256;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct GateCrossingEvent
+{
+	uint		m_carIndex = 0;
+	uint		m_gateIndex = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Lock free single producer / single consumer ring buffer. The PhysX simulation callback pushes and the game update drains,
+// nothing else may touch either end
+//------------------------------------------------------------------------------------------------------------------------------
+class GateEventQueue
+{
+public:
+	GateEventQueue();
+	~GateEventQueue();
+
+	//Producer side, returns false and drops the event if the queue is full
+	bool						Push(const GateCrossingEvent& gateEvent);
+
+	//Consumer side, returns false if there was nothing to pop
+	bool						Pop(GateCrossingEvent& outGateEvent);
+
+	//Number of events dropped since the last call, resets the count
+	uint						ConsumeDroppedEventCount();
+
+private:
+	GateCrossingEvent			m_events[GATE_EVENT_QUEUE_CAPACITY];
+
+	//Keep the two ends on separate cache lines so the threads don't fight over one line
+	alignas(64) std::atomic<uint>	m_writeIndex;
+	alignas(64) std::atomic<uint>	m_readIndex;
+	std::atomic<uint>			m_numDroppedEvents;
+};
@@ -9,9 +9,13 @@
 #include "Engine/Renderer/ImGUISystem.hpp"
 #include "Engine/Commons/EngineCommon.hpp"
 #include "Engine/Core/WindowContext.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
 //Game Systems
 #include "Game/GameCommon.hpp"
 #include "Game/App.hpp"
+#include "Game/TuningEvaluator.hpp"
+#include <fstream>
+#include <string>
 
 //Purely for debugging
 #include <stdio.h>
@@ -149,11 +153,80 @@ void Shutdown()
 }
 
 
+//-----------------------------------------------------------------------------------------------
+// Value of a key=value argument on the command line, values can't have spaces in them
+std::string GetCommandLineValue( const std::string& commandLine, const std::string& key, const std::string& defaultValue )
+{
+	std::string keyAndEquals = key + "=";
+	size_t keyStart = commandLine.find( keyAndEquals );
+	if( keyStart == std::string::npos )
+	{
+		return defaultValue;
+	}
+
+	size_t valueStart = keyStart + keyAndEquals.length();
+	size_t valueEnd = commandLine.find( ' ', valueStart );
+	return commandLine.substr( valueStart, valueEnd == std::string::npos ? std::string::npos : valueEnd - valueStart );
+}
+
+//-----------------------------------------------------------------------------------------------
+// This is a GUI subsystem exe, so stdout goes nowhere unless we borrow the console we were launched from.
+// The summary also goes to a log file for runs that weren't started from a console
+void ReportHeadlessTuningSummary( const std::string& summary, const std::string& logFilePath )
+{
+	DebuggerPrintf( "\n %s", summary.c_str() );
+
+	if( AttachConsole( ATTACH_PARENT_PROCESS ) )
+	{
+		FILE* consoleOutput = nullptr;
+		if( freopen_s( &consoleOutput, "CONOUT$", "w", stdout ) == 0 )
+		{
+			printf( "\n%s\n", summary.c_str() );
+			fflush( stdout );
+		}
+		FreeConsole();
+	}
+
+	std::ofstream logFile( logFilePath, std::ios::out | std::ios::trunc );
+	if( logFile.is_open() )
+	{
+		logFile << summary << "\n";
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+// tuningSweep=<file> runs the tuning evaluator and quits. No window, renderer or audio gets made, only PhysX,
+// so it works on build machines without a GPU
+int RunHeadlessTuningSweep( const std::string& commandLine )
+{
+	std::string sweepFilePath = GetCommandLineValue( commandLine, "tuningSweep", "Data/Gameplay/TuningSweep.xml" );
+	std::string csvFilePath = GetCommandLineValue( commandLine, "tuningOutput", "Data/Gameplay/TuningResults.csv" );
+	std::string logFilePath = GetCommandLineValue( commandLine, "tuningLog", "Data/Logs/TuningSweep.log" );
+	uint numThreads = (uint)atoi( GetCommandLineValue( commandLine, "tuningThreads", "0" ).c_str() );
+
+	g_PxPhysXSystem = new PhysXSystem();
+
+	std::string summary;
+	bool succeeded = TuningEvaluator::RunSweep( sweepFilePath, csvFilePath, numThreads, summary );
+	ReportHeadlessTuningSummary( summary, logFilePath );
+
+	delete g_PxPhysXSystem;
+	g_PxPhysXSystem = nullptr;
+
+	return succeeded ? 0 : 1;
+}
+
 //-----------------------------------------------------------------------------------------------
 int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int )
 {
-	UNUSED( commandLineString );
 	UNUSED( applicationInstanceHandle );
+
+	std::string commandLine = (commandLineString != nullptr) ? commandLineString : "";
+	if( commandLine.find( "tuningSweep=" ) != std::string::npos )
+	{
+		return RunHeadlessTuningSweep( commandLine );
+	}
+
 	Startup();
 
 	// Program main loop; keep running frames until it's time to quit
@@ -0,0 +1,234 @@
+#include "Game/ObstacleActivationManager.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ObstacleActivationManager::AddRegion(PxRigidDynamic* const* bodies, uint numBodies)
+{
+	m_regions.push_back(ObstacleRegion());
+	ObstacleRegion& region = m_regions.back();
+
+	region.m_bodies.assign(bodies, bodies + numBodies);
+	region.m_isBodyParked.assign(numBodies, false);
+	region.m_hadCCDEnabled.assign(numBodies, false);
+	region.m_wasBodyAwake.assign(numBodies, false);
+	region.m_parkedLinearVelocities.assign(numBodies, PxVec3(0.f));
+	region.m_parkedAngularVelocities.assign(numBodies, PxVec3(0.f));
+	UpdateRegionBounds(region);
+
+	return (uint)m_regions.size() - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ObstacleActivationManager::Clear()
+{
+	//The bodies belong to the scene, we only forget about them
+	m_regions.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ObstacleActivationManager::UpdateActivation(const PxVec3* carPositions, uint numCars)
+{
+	for (ObstacleRegion& region : m_regions)
+	{
+		switch (region.m_state)
+		{
+		case OBSTACLE_REGION_ACTIVE:
+		{
+			if (!IsAnyCarNear(region.m_bounds, m_deactivationDistance, carPositions, numCars))
+			{
+				//Bodies may have been knocked around while active, so measure again before deciding who is near
+				UpdateRegionBounds(region);
+				region.m_state = OBSTACLE_REGION_SETTLING;
+				region.m_numSettlingTicks = 0;
+			}
+		}
+		break;
+		case OBSTACLE_REGION_SETTLING:
+		{
+			if (IsAnyCarNear(region.m_bounds, m_activationDistance, carPositions, numCars))
+			{
+				ActivateRegion(region);
+			}
+			else
+			{
+				//Out of time to settle, whatever is still moving gets parked as it is
+				region.m_numSettlingTicks++;
+				bool parkAwakeBodies = region.m_numSettlingTicks >= m_maxSettlingTicks;
+				if (ParkBodies(region, parkAwakeBodies))
+				{
+					UpdateRegionBounds(region);
+					region.m_state = OBSTACLE_REGION_PARKED;
+				}
+			}
+		}
+		break;
+		case OBSTACLE_REGION_PARKED:
+		{
+			if (IsAnyCarNear(region.m_bounds, m_activationDistance, carPositions, numCars))
+			{
+				ActivateRegion(region);
+			}
+		}
+		break;
+		default:
+		break;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ObstacleActivationManager::SetActivationDistances(float activationDistance, float deactivationDistance)
+{
+	m_activationDistance = activationDistance;
+	m_deactivationDistance = PxMax(activationDistance, deactivationDistance);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ObstacleActivationManager::SetMaxSettlingTicks(uint maxSettlingTicks)
+{
+	m_maxSettlingTicks = maxSettlingTicks;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ObstacleActivationManager::GetNumRegions() const
+{
+	return (uint)m_regions.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ObstacleActivationManager::GetNumActiveRegions() const
+{
+	uint numActive = 0;
+	for (const ObstacleRegion& region : m_regions)
+	{
+		if (region.m_state == OBSTACLE_REGION_ACTIVE)
+		{
+			numActive++;
+		}
+	}
+
+	return numActive;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ObstacleActivationManager::GetNumParkedBodies() const
+{
+	uint numParked = 0;
+	for (const ObstacleRegion& region : m_regions)
+	{
+		for (bool isParked : region.m_isBodyParked)
+		{
+			numParked += isParked ? 1 : 0;
+		}
+	}
+
+	return numParked;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ObstacleActivationManager::ActivateRegion(ObstacleRegion& region)
+{
+	for (size_t bodyIndex = 0; bodyIndex < region.m_bodies.size(); bodyIndex++)
+	{
+		if (!region.m_isBodyParked[bodyIndex])
+		{
+			continue;
+		}
+
+		PxRigidDynamic* body = region.m_bodies[bodyIndex];
+		body->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, false);
+		if (region.m_hadCCDEnabled[bodyIndex])
+		{
+			body->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_CCD, true);
+		}
+
+		//Resting bodies stay asleep and out of the solver until a car actually touches them. Ones parked while still moving
+		//get the velocities they had back, so they pick up where they left off
+		if (region.m_wasBodyAwake[bodyIndex])
+		{
+			body->setLinearVelocity(region.m_parkedLinearVelocities[bodyIndex]);
+			body->setAngularVelocity(region.m_parkedAngularVelocities[bodyIndex]);
+			body->wakeUp();
+		}
+		else
+		{
+			body->putToSleep();
+		}
+		region.m_isBodyParked[bodyIndex] = false;
+	}
+
+	region.m_state = OBSTACLE_REGION_ACTIVE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool ObstacleActivationManager::ParkBodies(ObstacleRegion& region, bool parkAwakeBodies)
+{
+	bool allParked = true;
+	for (size_t bodyIndex = 0; bodyIndex < region.m_bodies.size(); bodyIndex++)
+	{
+		if (region.m_isBodyParked[bodyIndex])
+		{
+			continue;
+		}
+
+		//Anything still moving gets another tick to settle unless we've run out of patience
+		PxRigidDynamic* body = region.m_bodies[bodyIndex];
+		bool isAwake = !body->isSleeping();
+		if (isAwake && !parkAwakeBodies)
+		{
+			allParked = false;
+			continue;
+		}
+
+		if (isAwake)
+		{
+			//A kinematic body keeps nothing of its own velocity, hold on to it for activation
+			region.m_parkedLinearVelocities[bodyIndex] = body->getLinearVelocity();
+			region.m_parkedAngularVelocities[bodyIndex] = body->getAngularVelocity();
+			body->setLinearVelocity(PxVec3(0.f));
+			body->setAngularVelocity(PxVec3(0.f));
+		}
+		region.m_wasBodyAwake[bodyIndex] = isAwake;
+
+		bool hasCCD = body->getRigidBodyFlags() & PxRigidBodyFlag::eENABLE_CCD;
+		if (hasCCD)
+		{
+			body->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_CCD, false);
+		}
+		region.m_hadCCDEnabled[bodyIndex] = hasCCD;
+
+		body->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, true);
+		region.m_isBodyParked[bodyIndex] = true;
+	}
+
+	return allParked;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ObstacleActivationManager::UpdateRegionBounds(ObstacleRegion& region)
+{
+	region.m_bounds = PxBounds3::empty();
+	for (PxRigidDynamic* body : region.m_bodies)
+	{
+		region.m_bounds.include(body->getWorldBounds());
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool ObstacleActivationManager::IsAnyCarNear(const PxBounds3& bounds, float distance, const PxVec3* carPositions, uint numCars)
+{
+	if (bounds.isEmpty())
+	{
+		return false;
+	}
+
+	PxBounds3 nearBounds = PxBounds3::basisExtent(bounds.getCenter(), PxMat33(PxIdentity), bounds.getExtents() + PxVec3(distance));
+	for (uint carIndex = 0; carIndex < numCars; carIndex++)
+	{
+		if (nearBounds.contains(carPositions[carIndex]))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
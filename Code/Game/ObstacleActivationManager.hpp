@@ -0,0 +1,69 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eObstacleRegionState
+{
+	OBSTACLE_REGION_ACTIVE = 0,		//Plain dynamic bodies, the solver picks them up whenever they are awake
+	OBSTACLE_REGION_SETTLING,		//No car nearby, giving the bodies a few ticks to fall asleep before parking them
+	OBSTACLE_REGION_PARKED			//Every body is kinematic and costs nothing in the solver or island generation
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One cluster of dynamic obstacles, like a brick wall or the plank pile
+//------------------------------------------------------------------------------------------------------------------------------
+struct ObstacleRegion
+{
+	std::vector<PxRigidDynamic*>	m_bodies;
+	std::vector<bool>				m_isBodyParked;
+	std::vector<bool>				m_hadCCDEnabled;	//Kinematic bodies can't have CCD on, so we put it back on activation
+	std::vector<bool>				m_wasBodyAwake;		//Parked before it settled, so it gets woken up again on activation
+	std::vector<PxVec3>				m_parkedLinearVelocities;	//Only set for bodies parked while awake
+	std::vector<PxVec3>				m_parkedAngularVelocities;
+	PxBounds3						m_bounds = PxBounds3::empty();
+	eObstacleRegionState			m_state = OBSTACLE_REGION_SETTLING;
+	uint							m_numSettlingTicks = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Keeps dynamic obstacle clusters that no car is near parked as kinematic bodies, and hands them back to the solver once a car
+// gets within the activation distance. Bodies that fall asleep are parked straight away. Anything still awake once the settle
+// time runs out is parked where it is, keeping its velocities, and carries on moving on activation. A far region never keeps
+// costing solver time.
+// Runs on physics ticks between scene steps, never while the scene is simulating
+//------------------------------------------------------------------------------------------------------------------------------
+class ObstacleActivationManager
+{
+public:
+	//Bodies have to be in the scene already. Regions start settling and park themselves once nothing is moving
+	uint							AddRegion(PxRigidDynamic* const* bodies, uint numBodies);
+	void							Clear();
+
+	void							UpdateActivation(const PxVec3* carPositions, uint numCars);
+
+	//Deactivation is further out than activation so a car sitting on the edge doesn't flip a region every tick
+	void							SetActivationDistances(float activationDistance, float deactivationDistance);
+	//Physics ticks a region waits for its bodies to sleep before parking the ones still awake
+	void							SetMaxSettlingTicks(uint maxSettlingTicks);
+
+	uint							GetNumRegions() const;
+	uint							GetNumActiveRegions() const;
+	uint							GetNumParkedBodies() const;
+
+private:
+	void							ActivateRegion(ObstacleRegion& region);
+	bool							ParkBodies(ObstacleRegion& region, bool parkAwakeBodies);
+	void							UpdateRegionBounds(ObstacleRegion& region);
+
+	static bool						IsAnyCarNear(const PxBounds3& bounds, float distance, const PxVec3* carPositions, uint numCars);
+
+private:
+	std::vector<ObstacleRegion>		m_regions;
+
+	float							m_activationDistance = 30.f;
+	float							m_deactivationDistance = 45.f;
+	uint							m_maxSettlingTicks = 200;
+};
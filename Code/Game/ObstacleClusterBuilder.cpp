@@ -0,0 +1,305 @@
+#include "Game/ObstacleClusterBuilder.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+//Third Party
+#include "extensions/PxDefaultCpuDispatcher.h"
+#include <math.h>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void ObstacleClusterBuilder::BuildWall(std::vector<PxRigidDynamic*>& outBricks, int numHorizontalBoxes, int numVerticalBoxes, float boxSize, const PxVec3& pos, const PxQuat& quat, PxMaterial& material)
+{
+	const PxF32 density = 50.0f;
+
+	const PxF32 sizeX = boxSize;
+	const PxF32 sizeY = boxSize;
+	const PxF32 sizeZ = boxSize;
+
+	const PxF32 mass = sizeX * sizeY*sizeZ*density;
+	const PxVec3 halfExtents(sizeX*0.5f, sizeY*0.5f, sizeZ*0.5f);
+	PxBoxGeometry geometry(halfExtents);
+
+	const PxF32 spacing = 0.0001f;
+	PxVec3 relPos(0.0f, sizeY / 2, 0.0f);
+	PxF32 offsetX = -(numHorizontalBoxes * (sizeX + spacing) * 0.5f);
+	PxF32 offsetZ = 0.0f;
+
+	outBricks.reserve(outBricks.size() + numHorizontalBoxes * numVerticalBoxes);
+
+	for (PxU32 k = 0; k < (PxU32)numVerticalBoxes; k++)
+	{
+		for (PxU32 i = 0; i < (PxU32)numHorizontalBoxes; i++)
+		{
+			relPos.x = offsetX + (sizeX + spacing)*i;
+			relPos.z = offsetZ;
+			PxTransform transform(pos + quat.rotate(relPos), quat);
+
+			PxRigidDynamic* brick = CreateDynamicObstacleBody(transform, geometry, material);
+			PxRigidBodyExt::setMassAndUpdateInertia(*brick, mass);
+			outBricks.push_back(brick);
+		}
+
+		if (0 == (k % 2))
+		{
+			offsetX += sizeX / 2;
+		}
+		else
+		{
+			offsetX -= sizeX / 2;
+		}
+		relPos.y += (sizeY + spacing);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void ObstacleClusterBuilder::BuildPyramid(std::vector<PxRigidDynamic*>& outBoxes, const PxTransform& pose, uint size, float halfExtent, PxMaterial& material)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+
+	//We are going to make a stack of boxes
+	PxBoxGeometry box = PxBoxGeometry((PxReal)halfExtent, (PxReal)halfExtent, (PxReal)halfExtent);
+	PxShape* shape = physX->createShape(box, material);
+
+	outBoxes.reserve(outBoxes.size() + size * (size + 1) / 2);
+
+	//Loop to stack everything in a pyramid shape
+	for (PxU32 layerIndex = 0; layerIndex < size; layerIndex++)
+	{
+		for (PxU32 indexInLayer = 0; indexInLayer < size - layerIndex; indexInLayer++)
+		{
+			PxTransform localTm(PxVec3(PxReal(indexInLayer * 2) - PxReal(size - layerIndex), PxReal(layerIndex * 2 + 1), 0) * halfExtent);
+			PxRigidDynamic* body = physX->createRigidDynamic(pose.transform(localTm));
+			body->attachShape(*shape);
+			PxRigidBodyExt::updateMassAndInertia(*body, 10.0f);
+			outBoxes.push_back(body);
+		}
+	}
+
+	//The bodies hold their own references to the shared shape
+	shape->release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxRigidDynamic* ObstacleClusterBuilder::CreateDynamicObstacleBody(const PxTransform& transform, const PxGeometry& geometry, PxMaterial& material)
+{
+	PxRigidDynamic* body = g_PxPhysXSystem->GetPhysXSDK()->createRigidDynamic(transform);
+	PxShape* shape = PxRigidActorExt::createExclusiveShape(*body, geometry, material);
+
+	PxFilterData simFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_OBSTACLE_AGAINST, 0, 0);
+	shape->setSimulationFilterData(simFilterData);
+	PxFilterData qryFilterData;
+	setupDrivableSurface(qryFilterData);
+	shape->setQueryFilterData(qryFilterData);
+
+	return body;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint ObstacleClusterBuilder::InsertCluster(PxScene& scene, PxRigidDynamic* const* bodies, uint numBodies, eClusterInsertMode insertMode, bool enableSelfCollision, std::vector<PxAggregate*>* outAggregates)
+{
+	if (numBodies == 0)
+	{
+		return 0;
+	}
+
+	switch (insertMode)
+	{
+	case CLUSTER_INSERT_PER_ACTOR:
+	{
+		for (uint bodyIndex = 0; bodyIndex < numBodies; bodyIndex++)
+		{
+			scene.addActor(*bodies[bodyIndex]);
+		}
+		return 0;
+	}
+	case CLUSTER_INSERT_BATCHED:
+	{
+		scene.addActors((PxActor* const*)bodies, numBodies);
+		return 0;
+	}
+	case CLUSTER_INSERT_AGGREGATE:
+	default:
+	break;
+	}
+
+	//Bodies come out of the builders row by row, so consecutive chunks are also neighbours in space
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	uint numAggregates = 0;
+	for (uint firstBody = 0; firstBody < numBodies; firstBody += MAX_AGGREGATE_ACTORS)
+	{
+		uint numInChunk = PxMin(MAX_AGGREGATE_ACTORS, numBodies - firstBody);
+
+		PxAggregate* aggregate = physX->createAggregate(numInChunk, enableSelfCollision);
+		if (aggregate == nullptr)
+		{
+			scene.addActors((PxActor* const*)&bodies[firstBody], numInChunk);
+			continue;
+		}
+
+		for (uint bodyIndex = firstBody; bodyIndex < firstBody + numInChunk; bodyIndex++)
+		{
+			aggregate->addActor(*bodies[bodyIndex]);
+		}
+
+		scene.addAggregate(*aggregate);
+		numAggregates++;
+
+		if (outAggregates != nullptr)
+		{
+			outAggregates->push_back(aggregate);
+		}
+	}
+
+	return numAggregates;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* ObstacleClusterBuilder::GetNameForInsertMode(eClusterInsertMode insertMode)
+{
+	switch (insertMode)
+	{
+	case CLUSTER_INSERT_PER_ACTOR:
+		return "per actor";
+	case CLUSTER_INSERT_BATCHED:
+		return "addActors";
+	case CLUSTER_INSERT_AGGREGATE:
+	default:
+		return "aggregates";
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC eClusterInsertMode ObstacleClusterBuilder::GetInsertModeForName(const std::string& insertModeName, eClusterInsertMode defaultMode)
+{
+	for (int modeIndex = 0; modeIndex < NUM_CLUSTER_INSERT_MODES; modeIndex++)
+	{
+		if (insertModeName == GetNameForInsertMode((eClusterInsertMode)modeIndex))
+		{
+			return (eClusterInsertMode)modeIndex;
+		}
+	}
+
+	return defaultMode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void ObstacleClusterBuilder::RegisterConsoleCommands()
+{
+	g_eventSystem->SubscribeEventCallBackFn("BenchmarkObstacleClusters", Command_BenchmarkObstacleClusters);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool ObstacleClusterBuilder::Command_BenchmarkObstacleClusters(EventArgs& args)
+{
+	std::string key = "bricks";
+	std::string defaultValue = "1200";
+	uint numBricks = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	key = "steps";
+	defaultValue = "120";
+	uint numSteps = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	if (numBricks == 0 || numSteps == 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, "BenchmarkObstacleClusters needs bricks and steps greater than 0");
+		return false;
+	}
+
+	//Walls of 20 x 10 bricks on a grid, far enough apart that they never touch each other
+	const int wallWidth = 20;
+	const int wallHeight = 10;
+	const uint bricksPerWall = wallWidth * wallHeight;
+	const uint numWalls = (numBricks + bricksPerWall - 1) / bricksPerWall;
+	const uint wallsPerRow = (uint)ceilf(sqrtf((float)numWalls));
+	const float wallSpacing = 40.f;
+	const float stepTime = 1.f / 60.f;
+
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxScene* gameScene = g_PxPhysXSystem->GetPhysXScene();
+	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	g_devConsole->PrintString(Rgba::ORGANIC_BLUE, Stringf("Obstacle cluster benchmark: %u walls, %u bricks, %u steps", numWalls, numWalls * bricksPerWall, numSteps));
+
+	for (int modeIndex = 0; modeIndex < NUM_CLUSTER_INSERT_MODES; modeIndex++)
+	{
+		eClusterInsertMode insertMode = (eClusterInsertMode)modeIndex;
+
+		//Same filter shader as the game scene so obstacle pairs are filtered the way they would be on the track
+		PxSceneDesc sceneDesc(physX->getTolerancesScale());
+		sceneDesc.gravity = PxVec3(0.f, -9.81f, 0.f);
+		sceneDesc.filterShader = gameScene->getFilterShader();
+		sceneDesc.filterShaderData = gameScene->getFilterShaderData();
+		sceneDesc.filterShaderDataSize = gameScene->getFilterShaderDataSize();
+		PxDefaultCpuDispatcher* dispatcher = PxDefaultCpuDispatcherCreate(1);
+		sceneDesc.cpuDispatcher = dispatcher;
+		PxScene* scene = physX->createScene(sceneDesc);
+
+		PxRigidStatic* ground = PxCreatePlane(*physX, PxPlane(0.f, 1.f, 0.f, 0.f), *pxMaterial);
+		PxShape* groundShape = nullptr;
+		ground->getShapes(&groundShape, 1);
+		groundShape->setSimulationFilterData(PxFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_OBSTACLE_AGAINST, 0, 0));
+		scene->addActor(*ground);
+
+		//Build time covers making the bodies and getting them into the scene
+		double startTime = GetCurrentTimeSeconds();
+		std::vector<PxRigidDynamic*> allBricks;
+		std::vector<PxAggregate*> aggregates;
+		std::vector<PxRigidDynamic*> wallBricks;
+		for (uint wallIndex = 0; wallIndex < numWalls; wallIndex++)
+		{
+			PxVec3 wallPosition((float)(wallIndex % wallsPerRow) * wallSpacing, 0.f, (float)(wallIndex / wallsPerRow) * wallSpacing);
+
+			wallBricks.clear();
+			BuildWall(wallBricks, wallWidth, wallHeight, 1.f, wallPosition, PxQuat(PxIdentity), *pxMaterial);
+			InsertCluster(*scene, wallBricks.data(), (uint)wallBricks.size(), insertMode, true, &aggregates);
+			allBricks.insert(allBricks.end(), wallBricks.begin(), wallBricks.end());
+		}
+		double buildTime = GetCurrentTimeSeconds() - startTime;
+
+		//Split the step so the collide phase (broadphase and the first narrowphase pass) can be timed on its own
+		double collideTime = 0.0;
+		double simulateTime = 0.0;
+		for (uint stepIndex = 0; stepIndex < numSteps; stepIndex++)
+		{
+			startTime = GetCurrentTimeSeconds();
+			scene->collide(stepTime);
+			scene->fetchCollision(true);
+			double collideEndTime = GetCurrentTimeSeconds();
+			scene->advance();
+			scene->fetchResults(true);
+			double stepEndTime = GetCurrentTimeSeconds();
+
+			collideTime += collideEndTime - startTime;
+			simulateTime += stepEndTime - startTime;
+		}
+
+		PxSimulationStatistics stats;
+		scene->getSimulationStatistics(stats);
+
+		g_devConsole->PrintString(Rgba::WHITE, Stringf("%-10s build %.2f ms, collide %.3f ms/step, simulate %.3f ms/step, %u aggregates, %u awake",
+			GetNameForInsertMode(insertMode),
+			buildTime * 1000.0,
+			collideTime * 1000.0 / (double)numSteps,
+			simulateTime * 1000.0 / (double)numSteps,
+			(uint)aggregates.size(),
+			stats.nbActiveDynamicBodies));
+
+		//Releasing an actor takes it out of its aggregate, then the empty aggregates can go
+		for (PxRigidDynamic* brick : allBricks)
+		{
+			brick->release();
+		}
+		for (PxAggregate* aggregate : aggregates)
+		{
+			aggregate->release();
+		}
+		ground->release();
+		scene->release();
+		dispatcher->release();
+	}
+
+	return true;
+}
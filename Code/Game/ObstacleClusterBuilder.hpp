@@ -0,0 +1,48 @@
+#pragma once
+//Engine Systems
+#include "Engine/Core/EventSystems.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//PhysX won't create an aggregate bigger than this, larger clusters get split across several
+constexpr uint MAX_AGGREGATE_ACTORS = 128;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eClusterInsertMode
+{
+	CLUSTER_INSERT_PER_ACTOR = 0,	//One addActor call per body, how the builders used to do it
+	CLUSTER_INSERT_BATCHED,			//One addActors call for the whole cluster
+	CLUSTER_INSERT_AGGREGATE,		//Bodies grouped into aggregates so the broadphase sees one box per aggregate
+
+	NUM_CLUSTER_INSERT_MODES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Builds clusters of dynamic obstacles (brick walls, box pyramids) and inserts each one into a scene in one go.
+// Building and inserting are separate so the same bodies can go in as single actors, a batch or aggregates
+//------------------------------------------------------------------------------------------------------------------------------
+class ObstacleClusterBuilder
+{
+public:
+	//Builders only create the bodies, nothing is in a scene until InsertCluster
+	static void					BuildWall(std::vector<PxRigidDynamic*>& outBricks, int numHorizontalBoxes, int numVerticalBoxes, float boxSize, const PxVec3& pos, const PxQuat& quat, PxMaterial& material);
+	static void					BuildPyramid(std::vector<PxRigidDynamic*>& outBoxes, const PxTransform& pose, uint size, float halfExtent, PxMaterial& material);
+
+	//Obstacle filter data that collides with other obstacles and can be driven on, same as the engine's AddDynamicObstacle
+	static PxRigidDynamic*		CreateDynamicObstacleBody(const PxTransform& transform, const PxGeometry& geometry, PxMaterial& material);
+
+	//Returns how many aggregates were made. Bricks in a wall lean on each other, so self collision is on by default
+	static uint					InsertCluster(PxScene& scene, PxRigidDynamic* const* bodies, uint numBodies, eClusterInsertMode insertMode, bool enableSelfCollision = true, std::vector<PxAggregate*>* outAggregates = nullptr);
+
+	static const char*			GetNameForInsertMode(eClusterInsertMode insertMode);
+	//Takes the names GetNameForInsertMode prints, anything else gives back the default
+	static eClusterInsertMode	GetInsertModeForName(const std::string& insertModeName, eClusterInsertMode defaultMode = CLUSTER_INSERT_AGGREGATE);
+
+	static void					RegisterConsoleCommands();
+
+	//BenchmarkObstacleClusters bricks=1200 steps=120. Builds the same walls once per insert mode in a scratch scene and prints
+	//scene build time and the per step collide (broadphase) and total simulate time for each
+	static bool					Command_BenchmarkObstacleClusters(EventArgs& args);
+};
@@ -0,0 +1,62 @@
+#include "Game/PhysicsStepper.hpp"
+//Engine Systems
+#include "Engine/Core/Time.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsStepper::PhysicsStepper()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsStepper::~PhysicsStepper()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStepper::BeginStep(float deltaTime)
+{
+	ASSERT_RECOVERABLE(!m_isStepInFlight, "PhysicsStepper::BeginStep called with a step still in flight");
+	EndStep();
+
+	//simulate() hands the step to the scene's CPU dispatcher and returns straight away
+	g_PxPhysXSystem->GetPhysXScene()->simulate(deltaTime);
+
+	m_stepDeltaTime = deltaTime;
+	m_isStepInFlight = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsStepper::EndStep()
+{
+	if (!m_isStepInFlight)
+	{
+		return;
+	}
+
+	double waitStartTime = GetCurrentTimeSeconds();
+	g_PxPhysXSystem->GetPhysXScene()->fetchResults(true);
+	m_lastWaitTimeSeconds = GetCurrentTimeSeconds() - waitStartTime;
+
+	m_isStepInFlight = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsStepper::IsStepInFlight() const
+{
+	return m_isStepInFlight;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float PhysicsStepper::GetStepDeltaTime() const
+{
+	return m_stepDeltaTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double PhysicsStepper::GetLastWaitTimeSeconds() const
+{
+	return m_lastWaitTimeSeconds;
+}
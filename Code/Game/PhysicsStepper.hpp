@@ -0,0 +1,28 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Splits one PhysX step into a begin and an end so the scene can simulate on the PhysX worker threads while the main thread
+// does something else. Nothing may read or write the scene between BeginStep and EndStep other than through the snapshot
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysicsStepper
+{
+public:
+	PhysicsStepper();
+	~PhysicsStepper();
+
+	void				BeginStep(float deltaTime);
+	void				EndStep();
+
+	bool				IsStepInFlight() const;
+	float				GetStepDeltaTime() const;
+
+	//Time the last EndStep spent waiting on fetchResults, 0 means the step was already done when we got to it
+	double				GetLastWaitTimeSeconds() const;
+
+private:
+	bool				m_isStepInFlight = false;
+	float				m_stepDeltaTime = 0.f;
+	double				m_lastWaitTimeSeconds = 0.0;
+};
@@ -0,0 +1,108 @@
+#include "Game/PhysicsThread.hpp"
+//Engine Systems
+#include "Engine/Core/Time.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/Game.hpp"
+#include <chrono>
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsThread::PhysicsThread()
+{
+	m_isRunning = false;
+	m_stopRequested = false;
+	m_tickCount = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PhysicsThread::~PhysicsThread()
+{
+	Stop();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsThread::Start(Game* game, double fixedTimeStep, int maxTicksBehind, std::mutex* simulationLock)
+{
+	Stop();
+
+	m_game = game;
+	m_fixedTimeStep = fixedTimeStep;
+	m_maxTicksBehind = maxTicksBehind;
+	m_simulationLock = simulationLock;
+	m_tickCount = 0;
+
+	m_stopRequested = false;
+	m_isRunning = true;
+	m_thread = std::thread(&PhysicsThread::ThreadMain, this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsThread::Stop()
+{
+	if (!m_thread.joinable())
+	{
+		return;
+	}
+
+	m_stopRequested = true;
+	m_thread.join();
+	m_isRunning = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool PhysicsThread::IsRunning() const
+{
+	return m_isRunning;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double PhysicsThread::GetFixedTimeStep() const
+{
+	return m_fixedTimeStep;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint PhysicsThread::GetTickCount() const
+{
+	return m_tickCount;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PhysicsThread::ThreadMain()
+{
+	double nextTickTime = GetCurrentTimeSeconds() + m_fixedTimeStep;
+
+	while (!m_stopRequested)
+	{
+		double currentTime = GetCurrentTimeSeconds();
+		double timeToNextTick = nextTickTime - currentTime;
+		if (timeToNextTick > 0.0)
+		{
+			//Sleep is only as precise as the OS scheduler, so sleep most of the wait and spin out the rest
+			if (timeToNextTick > 0.002)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(*m_simulationLock);
+			g_PxPhysXSystem->Update((float)m_fixedTimeStep);
+			m_game->FixedUpdate((float)m_fixedTimeStep);
+		}
+
+		m_tickCount++;
+		nextTickTime += m_fixedTimeStep;
+
+		//Same rule as the main thread loop, if we fall too far behind we drop the time instead of trying to catch up
+		if (currentTime - nextTickTime > m_fixedTimeStep * (double)m_maxTicksBehind)
+		{
+			nextTickTime = currentTime + m_fixedTimeStep;
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+class Game;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Steps the PhysX scene and runs Game::FixedUpdate at a fixed rate on its own thread. Each tick holds the simulation lock,
+// which the main thread also holds for its update, so game state only ever has one writer at a time. Render does not take
+// the lock and reads the published vehicle snapshot instead
+//------------------------------------------------------------------------------------------------------------------------------
+class PhysicsThread
+{
+public:
+	PhysicsThread();
+	~PhysicsThread();
+
+	void					Start(Game* game, double fixedTimeStep, int maxTicksBehind, std::mutex* simulationLock);
+	void					Stop();
+
+	bool					IsRunning() const;
+	double					GetFixedTimeStep() const;
+	uint					GetTickCount() const;
+
+private:
+	void					ThreadMain();
+
+private:
+	std::thread				m_thread;
+	std::atomic<bool>		m_isRunning;
+	std::atomic<bool>		m_stopRequested;
+	std::atomic<uint>		m_tickCount;
+
+	Game*					m_game = nullptr;
+	std::mutex*				m_simulationLock = nullptr;
+	double					m_fixedTimeStep = 0.01;
+	int						m_maxTicksBehind = 5;
+};
@@ -0,0 +1,47 @@
+#include "Game/RaceClock.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+RaceClock::RaceClock()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+RaceClock::~RaceClock()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RaceClock::AdvanceTick(double fixedTimeStep)
+{
+	m_tickCount++;
+	m_fixedTimeStep = fixedTimeStep;
+
+	//Summing ticks instead of multiplying keeps the clock right if the step size is ever changed at runtime
+	m_time += fixedTimeStep;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint64_t RaceClock::GetTickCount() const
+{
+	return m_tickCount;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double RaceClock::GetFixedTimeStep() const
+{
+	return m_fixedTimeStep;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double RaceClock::GetTime() const
+{
+	return m_time;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double RaceClock::GetTimeInLastTick(float tickFraction) const
+{
+	return m_time - m_fixedTimeStep + (double)tickFraction * m_fixedTimeStep;
+}
@@ -0,0 +1,31 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Simulation time counted in fixed physics ticks. Advanced once per step of the App::Update accumulator loop, so race times
+// only depend on how many steps were simulated and never on when a frame happened to sample the clock
+//------------------------------------------------------------------------------------------------------------------------------
+class RaceClock
+{
+public:
+	RaceClock();
+	~RaceClock();
+
+	void				AdvanceTick(double fixedTimeStep);
+
+	uint64_t			GetTickCount() const;
+	double				GetFixedTimeStep() const;
+
+	//Time at the end of the last simulated tick
+	double				GetTime() const;
+
+	//Time at a fraction of the way through the last simulated tick, 0 is the start of the tick and 1 is the end
+	double				GetTimeInLastTick(float tickFraction) const;
+
+private:
+	uint64_t			m_tickCount = 0;
+	double				m_fixedTimeStep = 0.0;
+	double				m_time = 0.0;
+};
@@ -0,0 +1,83 @@
+#include "Game/RaceRanking.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+RaceRanking::RaceRanking()
+{
+	Reset(0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+RaceRanking::~RaceRanking()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RaceRanking::Reset(uint numCars)
+{
+	ASSERT_RECOVERABLE(numCars <= MAX_RANKED_CARS, "Too many cars for the race ranking");
+	m_numCars = (numCars <= MAX_RANKED_CARS) ? numCars : MAX_RANKED_CARS;
+
+	//Start in grid order
+	for (uint carIndex = 0; carIndex < MAX_RANKED_CARS; carIndex++)
+	{
+		m_progress[carIndex] = 0.0;
+		m_order[carIndex] = carIndex;
+		m_positions[carIndex] = carIndex + 1;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RaceRanking::SetCarProgress(uint carIndex, double progress)
+{
+	m_progress[carIndex] = progress;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RaceRanking::UpdateOrder()
+{
+	//Insertion sort on the previous order. Strictly greater keeps ties in their old order so positions don't flicker
+	for (uint orderIndex = 1; orderIndex < m_numCars; orderIndex++)
+	{
+		uint carIndex = m_order[orderIndex];
+		double progress = m_progress[carIndex];
+
+		uint insertIndex = orderIndex;
+		while (insertIndex > 0 && progress > m_progress[m_order[insertIndex - 1]])
+		{
+			m_order[insertIndex] = m_order[insertIndex - 1];
+			insertIndex--;
+		}
+
+		m_order[insertIndex] = carIndex;
+	}
+
+	for (uint orderIndex = 0; orderIndex < m_numCars; orderIndex++)
+	{
+		m_positions[m_order[orderIndex]] = orderIndex + 1;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint RaceRanking::GetNumCars() const
+{
+	return m_numCars;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double RaceRanking::GetCarProgress(uint carIndex) const
+{
+	return m_progress[carIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint RaceRanking::GetRacePosition(uint carIndex) const
+{
+	return m_positions[carIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint RaceRanking::GetCarIndexAtPosition(uint racePosition) const
+{
+	return m_order[racePosition - 1];
+}
@@ -0,0 +1,35 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint MAX_RANKED_CARS = 64;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Keeps the cars sorted by continuous track progress. Progress is updated every tick and the order is fixed up with an
+// insertion sort, which is close to linear because positions rarely change between ticks
+//------------------------------------------------------------------------------------------------------------------------------
+class RaceRanking
+{
+public:
+	RaceRanking();
+	~RaceRanking();
+
+	void				Reset(uint numCars);
+
+	void				SetCarProgress(uint carIndex, double progress);
+	void				UpdateOrder();
+
+	uint				GetNumCars() const;
+	double				GetCarProgress(uint carIndex) const;
+
+	//Positions start at 1 for the leader
+	uint				GetRacePosition(uint carIndex) const;
+	uint				GetCarIndexAtPosition(uint racePosition) const;
+
+private:
+	double				m_progress[MAX_RANKED_CARS];
+	uint				m_order[MAX_RANKED_CARS];			//Car indices, leader first
+	uint				m_positions[MAX_RANKED_CARS];		//Race position for each car index
+	uint				m_numCars = 0;
+};
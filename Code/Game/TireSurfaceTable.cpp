@@ -0,0 +1,197 @@
+#include "Game/TireSurfaceTable.hpp"
+//Engine Systems
+#include "Engine/Core/XMLUtils/XMLUtils.hpp"
+//Third Party
+#include "ThirdParty/TinyXML2/tinyxml2.h"
+
+//------------------------------------------------------------------------------------------------------------------------------
+TireSurfaceTable::TireSurfaceTable()
+{
+	for (int surfaceIndex = 0; surfaceIndex < NUM_TIRE_SURFACES; surfaceIndex++)
+	{
+		m_materials[surfaceIndex] = nullptr;
+	}
+
+	//Grip off the road drops the way it does on a real car, kerbs are a little slippery and loose surfaces a lot
+	m_surfaceDescs[TIRE_SURFACE_KERB].m_tireFrictionScale = 0.85f;
+	m_surfaceDescs[TIRE_SURFACE_GRASS].m_tireFrictionScale = 0.6f;
+	m_surfaceDescs[TIRE_SURFACE_GRASS].m_staticFriction = 0.4f;
+	m_surfaceDescs[TIRE_SURFACE_GRASS].m_dynamicFriction = 0.35f;
+	m_surfaceDescs[TIRE_SURFACE_GRASS].m_restitution = 0.2f;
+	m_surfaceDescs[TIRE_SURFACE_GRAVEL].m_tireFrictionScale = 0.5f;
+	m_surfaceDescs[TIRE_SURFACE_GRAVEL].m_staticFriction = 0.6f;
+	m_surfaceDescs[TIRE_SURFACE_GRAVEL].m_dynamicFriction = 0.5f;
+	m_surfaceDescs[TIRE_SURFACE_GRAVEL].m_restitution = 0.1f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TireSurfaceTable::~TireSurfaceTable()
+{
+	Shutdown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TireSurfaceTable::LoadFromXMLFile(const std::string& filePath)
+{
+	tinyxml2::XMLDocument surfaceDoc;
+	surfaceDoc.LoadFile(filePath.c_str());
+
+	if (surfaceDoc.ErrorID() != tinyxml2::XML_SUCCESS)
+	{
+		DebuggerPrintf("\n >> Error loading tire surface file %s, using defaults", filePath.c_str());
+		return false;
+	}
+
+	XMLElement* root = surfaceDoc.RootElement();
+	XMLElement* surfaceElement = root->FirstChildElement("Surface");
+	while (surfaceElement != nullptr)
+	{
+		std::string surfaceName = ParseXmlAttribute(*surfaceElement, "name", std::string(""));
+		eTireSurface surface = GetSurfaceForName(surfaceName, NUM_TIRE_SURFACES);
+		if (surface == NUM_TIRE_SURFACES)
+		{
+			DebuggerPrintf("\n >> Unknown tire surface %s in %s", surfaceName.c_str(), filePath.c_str());
+			surfaceElement = surfaceElement->NextSiblingElement("Surface");
+			continue;
+		}
+
+		TireSurfaceDesc& desc = m_surfaceDescs[surface];
+		desc.m_tireFrictionScale = ParseXmlAttribute(*surfaceElement, "tireFrictionScale", desc.m_tireFrictionScale);
+		desc.m_staticFriction = ParseXmlAttribute(*surfaceElement, "staticFriction", desc.m_staticFriction);
+		desc.m_dynamicFriction = ParseXmlAttribute(*surfaceElement, "dynamicFriction", desc.m_dynamicFriction);
+		desc.m_restitution = ParseXmlAttribute(*surfaceElement, "restitution", desc.m_restitution);
+
+		surfaceElement = surfaceElement->NextSiblingElement("Surface");
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TireSurfaceTable::Startup()
+{
+	Shutdown();
+
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	const PxVehicleDrivableSurfaceToTireFrictionPairs* basePairs = g_PxPhysXSystem->GetVehicleTireFrictionPairs();
+
+	//Road stays on the default material and keeps its material values, the table only scales its tire friction
+	PxMaterial* defaultMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
+	defaultMaterial->acquireReference();
+	m_materials[TIRE_SURFACE_ROAD] = defaultMaterial;
+
+	for (int surfaceIndex = TIRE_SURFACE_ROAD + 1; surfaceIndex < NUM_TIRE_SURFACES; surfaceIndex++)
+	{
+		const TireSurfaceDesc& desc = m_surfaceDescs[surfaceIndex];
+		m_materials[surfaceIndex] = physX->createMaterial(desc.m_staticFriction, desc.m_dynamicFriction, desc.m_restitution);
+	}
+
+	//The material array is in surface order, so the surface type the SDK finds for a material is its index here
+	PxVehicleDrivableSurfaceType surfaceTypes[NUM_TIRE_SURFACES];
+	const PxMaterial* surfaceMaterials[NUM_TIRE_SURFACES];
+	for (int surfaceIndex = 0; surfaceIndex < NUM_TIRE_SURFACES; surfaceIndex++)
+	{
+		surfaceTypes[surfaceIndex].mType = (PxU32)surfaceIndex;
+		surfaceMaterials[surfaceIndex] = m_materials[surfaceIndex];
+	}
+
+	//Keep the engine's tire types and their road grip, each surface scales that
+	PxU32 numTireTypes = basePairs->getNbTireTypes();
+	m_frictionPairs = PxVehicleDrivableSurfaceToTireFrictionPairs::allocate(numTireTypes, NUM_TIRE_SURFACES);
+	m_frictionPairs->setup(numTireTypes, NUM_TIRE_SURFACES, surfaceMaterials, surfaceTypes);
+
+	for (int surfaceIndex = 0; surfaceIndex < NUM_TIRE_SURFACES; surfaceIndex++)
+	{
+		for (PxU32 tireType = 0; tireType < numTireTypes; tireType++)
+		{
+			float roadFriction = basePairs->getTypePairFriction(0, tireType);
+			m_frictionPairs->setTypePairFriction((PxU32)surfaceIndex, tireType, roadFriction * m_surfaceDescs[surfaceIndex].m_tireFrictionScale);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TireSurfaceTable::Shutdown()
+{
+	if (m_frictionPairs != nullptr)
+	{
+		m_frictionPairs->release();
+		m_frictionPairs = nullptr;
+	}
+
+	//Shapes hold their own references, this only drops ours
+	for (int surfaceIndex = 0; surfaceIndex < NUM_TIRE_SURFACES; surfaceIndex++)
+	{
+		if (m_materials[surfaceIndex] != nullptr)
+		{
+			m_materials[surfaceIndex]->release();
+			m_materials[surfaceIndex] = nullptr;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const PxVehicleDrivableSurfaceToTireFrictionPairs* TireSurfaceTable::GetFrictionPairs() const
+{
+	return m_frictionPairs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxMaterial* TireSurfaceTable::GetMaterial(eTireSurface surface) const
+{
+	return m_materials[surface];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const TireSurfaceDesc& TireSurfaceTable::GetSurfaceDesc(eTireSurface surface) const
+{
+	return m_surfaceDescs[surface];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TireSurfaceTable::ApplySurfaceToShape(PxShape& shape, eTireSurface surface) const
+{
+	if (m_materials[surface] != nullptr)
+	{
+		shape.setMaterials(&m_materials[surface], 1);
+	}
+
+	//Drivable surfaces are told apart by word3 and nothing filters on word2, so the surface lives there
+	PxFilterData qryFilterData = shape.getQueryFilterData();
+	qryFilterData.word2 = (PxU32)surface;
+	shape.setQueryFilterData(qryFilterData);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC eTireSurface TireSurfaceTable::GetSurfaceForShape(const PxShape& shape)
+{
+	PxU32 surface = shape.getQueryFilterData().word2;
+	return (surface < NUM_TIRE_SURFACES) ? (eTireSurface)surface : TIRE_SURFACE_ROAD;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC eTireSurface TireSurfaceTable::GetSurfaceForName(const std::string& surfaceName, eTireSurface defaultSurface)
+{
+	for (int surfaceIndex = 0; surfaceIndex < NUM_TIRE_SURFACES; surfaceIndex++)
+	{
+		if (surfaceName == GetNameForSurface((eTireSurface)surfaceIndex))
+		{
+			return (eTireSurface)surfaceIndex;
+		}
+	}
+
+	return defaultSurface;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* TireSurfaceTable::GetNameForSurface(eTireSurface surface)
+{
+	switch (surface)
+	{
+	case TIRE_SURFACE_ROAD:		return "road";
+	case TIRE_SURFACE_KERB:		return "kerb";
+	case TIRE_SURFACE_GRASS:	return "grass";
+	case TIRE_SURFACE_GRAVEL:	return "gravel";
+	default:					return "unknown";
+	}
+}
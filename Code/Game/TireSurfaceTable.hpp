@@ -0,0 +1,62 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// What a wheel is driving on. The value doubles as the surface type in the tire friction table
+//------------------------------------------------------------------------------------------------------------------------------
+enum eTireSurface
+{
+	TIRE_SURFACE_ROAD = 0,
+	TIRE_SURFACE_KERB,
+	TIRE_SURFACE_GRASS,
+	TIRE_SURFACE_GRAVEL,
+
+	NUM_TIRE_SURFACES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct TireSurfaceDesc
+{
+	float		m_tireFrictionScale = 1.f;		//Scales the engine's road friction for every tire type
+	float		m_staticFriction = 0.5f;		//Material values, used for chassis and obstacle contacts
+	float		m_dynamicFriction = 0.5f;
+	float		m_restitution = 0.6f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One PxMaterial and one row of the tire friction table per surface. Surfaces are resolved from their names once at load and
+// put on the shapes, so at runtime the vehicle SDK only compares the hit material against a handful of pointers and the game
+// reads a shape's surface back from its query filter data
+//------------------------------------------------------------------------------------------------------------------------------
+class TireSurfaceTable
+{
+public:
+	TireSurfaceTable();
+	~TireSurfaceTable();
+
+	//Anything not in the file keeps its default
+	bool														LoadFromXMLFile(const std::string& filePath);
+
+	//Road uses the engine's default material so every shape that never had a surface set still drives like road
+	void														Startup();
+	void														Shutdown();
+
+	const PxVehicleDrivableSurfaceToTireFrictionPairs*			GetFrictionPairs() const;
+	PxMaterial*													GetMaterial(eTireSurface surface) const;
+	const TireSurfaceDesc&										GetSurfaceDesc(eTireSurface surface) const;
+
+	//Sets the material and caches the surface on the shape. Filter data has to be set up before this
+	void														ApplySurfaceToShape(PxShape& shape, eTireSurface surface) const;
+	static eTireSurface											GetSurfaceForShape(const PxShape& shape);
+
+	static eTireSurface											GetSurfaceForName(const std::string& surfaceName, eTireSurface defaultSurface = TIRE_SURFACE_ROAD);
+	static const char*											GetNameForSurface(eTireSurface surface);
+
+private:
+	TireSurfaceDesc												m_surfaceDescs[NUM_TIRE_SURFACES];
+	PxMaterial*													m_materials[NUM_TIRE_SURFACES];
+	PxVehicleDrivableSurfaceToTireFrictionPairs*				m_frictionPairs = nullptr;
+};
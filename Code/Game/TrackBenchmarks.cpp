@@ -0,0 +1,275 @@
+#include "Game/TrackBenchmarks.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/CarTool.hpp"
+#include "Game/TrackCenterline.hpp"
+#include "Game/TrackGateTable.hpp"
+#include "Game/TrackRespawnPoses.hpp"
+#include "Game/VehicleManager.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TrackBenchmarks::RegisterConsoleCommands()
+{
+	g_eventSystem->SubscribeEventCallBackFn("BenchmarkGateQueries", Command_BenchmarkGateQueries);
+	g_eventSystem->SubscribeEventCallBackFn("BenchmarkVehicles", Command_BenchmarkVehicles);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackBenchmarks::Command_BenchmarkGateQueries(EventArgs& args)
+{
+	std::string key = "gates";
+	std::string defaultValue = "10000";
+	uint numGates = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	key = "queries";
+	defaultValue = "100000";
+	uint numQueries = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	if (numGates == 0 || numQueries == 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, "BenchmarkGateQueries needs gates and queries greater than 0");
+		return false;
+	}
+
+	//Lay the gates out along a big loop so the density looks like a real track instead of uniform noise
+	const float trackRadius = 10.f * (float)numGates / 6.28f + 100.f;
+	TrackGateTable gateTable;
+	for (uint gateIndex = 0; gateIndex < numGates; gateIndex++)
+	{
+		float angleRadians = 6.28f * (float)gateIndex / (float)numGates;
+		Vec3 position = Vec3(cosf(angleRadians) * trackRadius, 0.f, sinf(angleRadians) * trackRadius);
+		position.x += g_RNG->GetRandomFloatInRange(-20.f, 20.f);
+		position.z += g_RNG->GetRandomFloatInRange(-20.f, 20.f);
+		Vec3 halfExtents = Vec3(g_RNG->GetRandomFloatInRange(1.f, 8.f), 5.f, g_RNG->GetRandomFloatInRange(1.f, 8.f));
+
+		gateTable.AddGate(position, halfExtents);
+	}
+
+	double buildStart = GetCurrentTimeSeconds();
+	gateTable.BuildSpatialGrid(25.f);
+	double buildTime = GetCurrentTimeSeconds() - buildStart;
+
+	//Query points scattered around the loop where cars would be driving
+	std::vector<Vec3> queryPoints;
+	queryPoints.reserve(numQueries);
+	for (uint queryIndex = 0; queryIndex < numQueries; queryIndex++)
+	{
+		float angleRadians = g_RNG->GetRandomFloatInRange(0.f, 6.28f);
+		float radius = trackRadius + g_RNG->GetRandomFloatInRange(-30.f, 30.f);
+		queryPoints.push_back(Vec3(cosf(angleRadians) * radius, g_RNG->GetRandomFloatInRange(-2.f, 2.f), sinf(angleRadians) * radius));
+	}
+
+	//The linear scan is slow enough at 10k gates that we only time a slice of the queries for it
+	uint numLinearQueries = (numQueries < 10000) ? numQueries : 10000;
+	int checksum = 0;
+	uint numMismatches = 0;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (uint queryIndex = 0; queryIndex < numQueries; queryIndex++)
+	{
+		checksum += gateTable.FindGateContainingPoint(queryPoints[queryIndex]);
+	}
+	double gridContainsTime = GetCurrentTimeSeconds() - startTime;
+
+	startTime = GetCurrentTimeSeconds();
+	for (uint queryIndex = 0; queryIndex < numLinearQueries; queryIndex++)
+	{
+		checksum += gateTable.FindGateContainingPointLinear(queryPoints[queryIndex]);
+	}
+	double linearContainsTime = GetCurrentTimeSeconds() - startTime;
+
+	startTime = GetCurrentTimeSeconds();
+	for (uint queryIndex = 0; queryIndex < numQueries; queryIndex++)
+	{
+		checksum += gateTable.FindNearestGate(queryPoints[queryIndex]);
+	}
+	double gridNearestTime = GetCurrentTimeSeconds() - startTime;
+
+	startTime = GetCurrentTimeSeconds();
+	for (uint queryIndex = 0; queryIndex < numLinearQueries; queryIndex++)
+	{
+		checksum += gateTable.FindNearestGateLinear(queryPoints[queryIndex]);
+	}
+	double linearNearestTime = GetCurrentTimeSeconds() - startTime;
+
+	//Make sure the grid agrees with brute force on every query before trusting the numbers. Two gates can be the same
+	//distance away, so a different nearest gate only counts when it is actually further than the linear scan's
+	uint numNearestMismatches = 0;
+	for (uint queryIndex = 0; queryIndex < numQueries; queryIndex++)
+	{
+		const Vec3& queryPoint = queryPoints[queryIndex];
+
+		bool gridInside = gateTable.FindGateContainingPoint(queryPoint) != -1;
+		bool linearInside = gateTable.FindGateContainingPointLinear(queryPoint) != -1;
+		if (gridInside != linearInside)
+		{
+			numMismatches++;
+		}
+
+		int gridNearest = gateTable.FindNearestGate(queryPoint);
+		int linearNearest = gateTable.FindNearestGateLinear(queryPoint);
+		if (gridNearest != linearNearest)
+		{
+			if (gridNearest == -1 || linearNearest == -1 ||
+				gateTable.GetDistanceSquaredToGate((uint)gridNearest, queryPoint) > gateTable.GetDistanceSquaredToGate((uint)linearNearest, queryPoint) + 1e-4f)
+			{
+				numNearestMismatches++;
+			}
+		}
+	}
+
+	double gridContainsNs = gridContainsTime * 1e9 / (double)numQueries;
+	double linearContainsNs = linearContainsTime * 1e9 / (double)numLinearQueries;
+	double gridNearestNs = gridNearestTime * 1e9 / (double)numQueries;
+	double linearNearestNs = linearNearestTime * 1e9 / (double)numLinearQueries;
+
+	g_devConsole->PrintString(Rgba::ORGANIC_BLUE, Stringf("Gate query benchmark: %u gates, %u queries, grid built in %.3f ms", numGates, numQueries, buildTime * 1000.0));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Contains: grid %.1f ns/query, linear %.1f ns/query (%.1fx)", gridContainsNs, linearContainsNs, linearContainsNs / gridContainsNs));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Nearest:  grid %.1f ns/query, linear %.1f ns/query (%.1fx)", gridNearestNs, linearNearestNs, linearNearestNs / gridNearestNs));
+
+	if (numMismatches > 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, Stringf("Grid and linear scan disagreed on containment for %u queries", numMismatches));
+	}
+
+	if (numNearestMismatches > 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, Stringf("Grid and linear scan disagreed on the nearest gate for %u queries", numNearestMismatches));
+	}
+
+	if (numMismatches == 0 && numNearestMismatches == 0)
+	{
+		g_devConsole->PrintString(Rgba::GREEN, Stringf("Grid matched the linear scan on all %u queries", numQueries));
+	}
+
+	DebuggerPrintf("\n Gate benchmark checksum %d", checksum);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackBenchmarks::Command_BenchmarkVehicles(EventArgs& args)
+{
+	std::string key = "cars";
+	std::string defaultValue = "64";
+	uint numCars = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	key = "ticks";
+	defaultValue = "200";
+	uint numTicks = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	key = "threads";
+	defaultValue = "0";
+	uint maxThreads = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	key = "contact";
+	defaultValue = "ray";
+	std::string contactName = args.GetValue(key, defaultValue);
+	eWheelContactMode contactMode = (contactName == "sweep") ? WHEEL_CONTACT_SWEEP : WHEEL_CONTACT_RAYCAST;
+
+	key = "hits";
+	defaultValue = "4";
+	uint numSweepHits = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	if (numCars == 0 || numCars > MAX_MANAGED_VEHICLES || numTicks == 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, Stringf("BenchmarkVehicles needs cars between 1 and %u and ticks greater than 0", MAX_MANAGED_VEHICLES));
+		return false;
+	}
+
+	if (maxThreads == 0)
+	{
+		maxThreads = std::thread::hardware_concurrency();
+	}
+
+	//Spawn points come from the same centerline the race uses
+	TrackGateTable trackGates;
+	if (!trackGates.LoadFromXMLFile("Data/Gameplay/TrackGates.xml"))
+	{
+		g_devConsole->PrintString(Rgba::RED, "BenchmarkVehicles couldn't load the track gates");
+		return false;
+	}
+
+	TrackCenterline centerline;
+	centerline.BuildFromGates(trackGates);
+	TrackRespawnPoses spawnPoses;
+	spawnPoses.BuildFromCenterline(centerline);
+
+	uint numPoses = spawnPoses.GetNumPoses();
+	if (numPoses == 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, "BenchmarkVehicles has no spawn poses on the track");
+		return false;
+	}
+
+	//Two lanes of cars, skipping every other pose so the chassis don't overlap along the track
+	CarTool carTool;
+	std::vector<PxVehicleWheels*> vehicles;
+	vehicles.reserve(numCars);
+	for (uint carIndex = 0; carIndex < numCars; carIndex++)
+	{
+		const RespawnPose& pose = spawnPoses.GetPose(((carIndex / 2) * 2) % numPoses);
+		Vec3 right = Vec3(pose.m_forward.z, 0.f, -pose.m_forward.x);
+		float laneOffset = (carIndex % 2 == 0) ? -2.f : 2.f;
+		Vec3 position = pose.m_position + right * laneOffset + Vec3(0.f, 1.f, 0.f);
+
+		PxVehicleDrive4W* vehicle = carTool.MakeNewCar();
+		PxTransform transform;
+		transform.p = PhysXSystem::VecToPxVector(position);
+		transform.q = PxQuat(atan2f(pose.m_forward.x, pose.m_forward.z), PxVec3(0.f, 1.f, 0.f));
+		vehicle->getRigidDynamicActor()->setGlobalPose(transform);
+		vehicle->mDriveDynData.forceGearChange(PxVehicleGearsData::eFIRST);
+		vehicle->mDriveDynData.setAnalogInput(PxVehicleDrive4WControl::eANALOG_INPUT_ACCEL, 0.5f);
+
+		vehicles.push_back(vehicle);
+	}
+
+	//Only the vehicle update is timed, the scene isn't stepped so every thread count sees the same poses
+	const float fixedTimeStep = 0.01f;
+	VehicleManager* vehicleManager = new VehicleManager();
+	vehicleManager->SetWheelContactMode(contactMode, numSweepHits);
+	vehicleManager->Startup();
+
+	g_devConsole->PrintString(Rgba::ORGANIC_BLUE, Stringf("Vehicle benchmark: %u cars, %u ticks, %u chunks, %s contact", numCars, numTicks, (numCars + VEHICLES_PER_CHUNK - 1) / VEHICLES_PER_CHUNK, (contactMode == WHEEL_CONTACT_SWEEP) ? "sweep" : "ray"));
+
+	double singleThreadTime = 0.0;
+	for (uint numThreads = 1; numThreads <= maxThreads; numThreads++)
+	{
+		vehicleManager->SetNumWorkerThreads(numThreads - 1);
+
+		double startTime = GetCurrentTimeSeconds();
+		for (uint tickIndex = 0; tickIndex < numTicks; tickIndex++)
+		{
+			vehicleManager->UpdateVehicles(fixedTimeStep, vehicles.data(), numCars);
+		}
+		double totalTime = GetCurrentTimeSeconds() - startTime;
+
+		if (numThreads == 1)
+		{
+			singleThreadTime = totalTime;
+		}
+
+		double tickUs = totalTime * 1e6 / (double)numTicks;
+		g_devConsole->PrintString(Rgba::WHITE, Stringf("%u threads: %.1f us/tick (%.2fx)", numThreads, tickUs, singleThreadTime / totalTime));
+	}
+
+	vehicleManager->Shutdown();
+	delete vehicleManager;
+
+	PxScene* scene = g_PxPhysXSystem->GetPhysXScene();
+	for (PxVehicleWheels* vehicle : vehicles)
+	{
+		scene->removeActor(*vehicle->getRigidDynamicActor());
+		vehicle->getRigidDynamicActor()->release();
+		vehicle->release();
+	}
+
+	return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+//Engine Systems
+#include "Engine/Core/EventSystems.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Dev console commands that measure the track systems on generated data
+//------------------------------------------------------------------------------------------------------------------------------
+class TrackBenchmarks
+{
+public:
+	static void		RegisterConsoleCommands();
+
+	//BenchmarkGateQueries gates=10000 queries=100000
+	static bool		Command_BenchmarkGateQueries(EventArgs& args);
+
+	//BenchmarkVehicles cars=64 ticks=200 threads=0 contact=ray hits=4. Spawns cars along the loaded track and times the vehicle
+	//update for every thread count up to threads (0 means use every core). contact=sweep uses suspension sweeps with hits per wheel.
+	//Start a race first so the track colliders are in the scene
+	static bool		Command_BenchmarkVehicles(EventArgs& args);
+};
@@ -0,0 +1,323 @@
+#include "Game/TrackCenterline.hpp"
+//Engine Systems
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Vertex_Lit.hpp"
+#include "Engine/Renderer/CPUMesh.hpp"
+#include "Engine/Renderer/GPUMesh.hpp"
+#include "Engine/Renderer/RenderContext.hpp"
+//Game Systems
+#include "Game/TrackGateTable.hpp"
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static Vec3 EvaluateCatmullRom(const Vec3& p0, const Vec3& p1, const Vec3& p2, const Vec3& p3, float t)
+{
+	float t2 = t * t;
+	float t3 = t2 * t;
+
+	//Uniform Catmull-Rom basis weights
+	float w0 = 0.5f * (-t3 + 2.f * t2 - t);
+	float w1 = 0.5f * (3.f * t3 - 5.f * t2 + 2.f);
+	float w2 = 0.5f * (-3.f * t3 + 4.f * t2 + t);
+	float w3 = 0.5f * (t3 - t2);
+
+	return Vec3(p0.x * w0 + p1.x * w1 + p2.x * w2 + p3.x * w3,
+				p0.y * w0 + p1.y * w1 + p2.y * w2 + p3.y * w3,
+				p0.z * w0 + p1.z * w1 + p2.z * w2 + p3.z * w3);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackCenterline::TrackCenterline()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackCenterline::~TrackCenterline()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::BuildFromGates(const TrackGateTable& trackGates, uint samplesPerSpan, float cellSize)
+{
+	std::vector<Vec3> controlPoints;
+	uint numGates = trackGates.GetNumGates();
+	for (uint gateIndex = 0; gateIndex < numGates; gateIndex++)
+	{
+		controlPoints.push_back(trackGates.GetGatePosition(gateIndex));
+	}
+
+	BuildFromControlPoints(controlPoints, samplesPerSpan, cellSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::BuildFromControlPoints(const std::vector<Vec3>& controlPoints, uint samplesPerSpan, float cellSize)
+{
+	Clear();
+
+	uint numControlPoints = (uint)controlPoints.size();
+	if (numControlPoints < 2 || samplesPerSpan == 0)
+	{
+		return;
+	}
+
+	//Bake the closed spline into a polyline, one span per pair of control points
+	m_points.reserve(numControlPoints * samplesPerSpan + 1);
+	for (uint spanIndex = 0; spanIndex < numControlPoints; spanIndex++)
+	{
+		const Vec3& p0 = controlPoints[(spanIndex + numControlPoints - 1) % numControlPoints];
+		const Vec3& p1 = controlPoints[spanIndex];
+		const Vec3& p2 = controlPoints[(spanIndex + 1) % numControlPoints];
+		const Vec3& p3 = controlPoints[(spanIndex + 2) % numControlPoints];
+
+		for (uint sampleIndex = 0; sampleIndex < samplesPerSpan; sampleIndex++)
+		{
+			float t = (float)sampleIndex / (float)samplesPerSpan;
+			m_points.push_back(EvaluateCatmullRom(p0, p1, p2, p3, t));
+		}
+	}
+
+	m_points.push_back(m_points[0]);
+
+	//Arc length lookup table
+	m_cumulativeLengths.reserve(m_points.size());
+	m_cumulativeLengths.push_back(0.f);
+	for (uint pointIndex = 1; pointIndex < (uint)m_points.size(); pointIndex++)
+	{
+		Vec3 segment = m_points[pointIndex] - m_points[pointIndex - 1];
+		float segmentLength = sqrtf(segment.x * segment.x + segment.y * segment.y + segment.z * segment.z);
+		m_cumulativeLengths.push_back(m_cumulativeLengths[pointIndex - 1] + segmentLength);
+	}
+
+	BuildSegmentGrid(cellSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::Clear()
+{
+	m_points.clear();
+	m_cumulativeLengths.clear();
+
+	m_segmentGrid.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TrackCenterline::IsValid() const
+{
+	return m_points.size() > 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float TrackCenterline::GetTrackLength() const
+{
+	if (m_cumulativeLengths.empty())
+	{
+		return 0.f;
+	}
+
+	return m_cumulativeLengths.back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint TrackCenterline::GetNumSegments() const
+{
+	if (m_points.empty())
+	{
+		return 0;
+	}
+
+	return (uint)m_points.size() - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::BuildSegmentGrid(float cellSize)
+{
+	//Each segment goes in every cell its XZ bounds touch
+	uint numSegments = GetNumSegments();
+	std::vector<SpatialGridItemBounds> segmentBounds(numSegments);
+	for (uint segmentIndex = 0; segmentIndex < numSegments; segmentIndex++)
+	{
+		const Vec3& start = m_points[segmentIndex];
+		const Vec3& end = m_points[segmentIndex + 1];
+
+		segmentBounds[segmentIndex].m_minX = (start.x < end.x) ? start.x : end.x;
+		segmentBounds[segmentIndex].m_minZ = (start.z < end.z) ? start.z : end.z;
+		segmentBounds[segmentIndex].m_maxX = (start.x > end.x) ? start.x : end.x;
+		segmentBounds[segmentIndex].m_maxZ = (start.z > end.z) ? start.z : end.z;
+	}
+
+	m_segmentGrid.Build(segmentBounds, cellSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackProjection TrackCenterline::ProjectPoint(const Vec3& point) const
+{
+	TrackProjection bestProjection;
+	bestProjection.m_distanceSquared = -1.f;
+
+	if (!IsValid())
+	{
+		return bestProjection;
+	}
+
+	int nearestSegment = m_segmentGrid.FindNearestItem(point, GetSegmentDistanceSquared, this);
+	if (nearestSegment == -1)
+	{
+		return ProjectPointLinear(point);
+	}
+
+	TestSegment((uint)nearestSegment, point, bestProjection);
+	FinalizeProjection(point, bestProjection);
+	return bestProjection;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackProjection TrackCenterline::ProjectPointLinear(const Vec3& point) const
+{
+	TrackProjection bestProjection;
+	bestProjection.m_distanceSquared = -1.f;
+
+	uint numSegments = GetNumSegments();
+	for (uint segmentIndex = 0; segmentIndex < numSegments; segmentIndex++)
+	{
+		TestSegment(segmentIndex, point, bestProjection);
+	}
+
+	if (bestProjection.m_distanceSquared >= 0.f)
+	{
+		FinalizeProjection(point, bestProjection);
+	}
+
+	return bestProjection;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::TestSegment(uint segmentIndex, const Vec3& point, TrackProjection& bestProjection) const
+{
+	const Vec3& start = m_points[segmentIndex];
+	const Vec3& end = m_points[segmentIndex + 1];
+
+	float segmentX = end.x - start.x;
+	float segmentY = end.y - start.y;
+	float segmentZ = end.z - start.z;
+	float segmentLengthSquared = segmentX * segmentX + segmentY * segmentY + segmentZ * segmentZ;
+
+	float t = 0.f;
+	if (segmentLengthSquared > 0.f)
+	{
+		t = ((point.x - start.x) * segmentX + (point.y - start.y) * segmentY + (point.z - start.z) * segmentZ) / segmentLengthSquared;
+		t = (t < 0.f) ? 0.f : ((t > 1.f) ? 1.f : t);
+	}
+
+	Vec3 closestPoint = Vec3(start.x + segmentX * t, start.y + segmentY * t, start.z + segmentZ * t);
+	float deltaX = point.x - closestPoint.x;
+	float deltaY = point.y - closestPoint.y;
+	float deltaZ = point.z - closestPoint.z;
+	float distanceSquared = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+
+	if (bestProjection.m_distanceSquared < 0.f || distanceSquared < bestProjection.m_distanceSquared)
+	{
+		bestProjection.m_distanceSquared = distanceSquared;
+		bestProjection.m_closestPoint = closestPoint;
+		bestProjection.m_segmentIndex = segmentIndex;
+		bestProjection.m_trackDistance = m_cumulativeLengths[segmentIndex] + t * (m_cumulativeLengths[segmentIndex + 1] - m_cumulativeLengths[segmentIndex]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC float TrackCenterline::GetSegmentDistanceSquared(uint segmentIndex, const Vec3& point, const void* userData)
+{
+	TrackProjection projection;
+	projection.m_distanceSquared = -1.f;
+	reinterpret_cast<const TrackCenterline*>(userData)->TestSegment(segmentIndex, point, projection);
+	return projection.m_distanceSquared;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::FinalizeProjection(const Vec3& point, TrackProjection& projection) const
+{
+	//Tangent and side only need computing once for the winning segment
+	const Vec3& start = m_points[projection.m_segmentIndex];
+	const Vec3& end = m_points[projection.m_segmentIndex + 1];
+	float segmentLength = m_cumulativeLengths[projection.m_segmentIndex + 1] - m_cumulativeLengths[projection.m_segmentIndex];
+
+	if (segmentLength > 0.f)
+	{
+		projection.m_tangent = Vec3((end.x - start.x) / segmentLength, (end.y - start.y) / segmentLength, (end.z - start.z) / segmentLength);
+	}
+
+	float offsetX = point.x - projection.m_closestPoint.x;
+	float offsetZ = point.z - projection.m_closestPoint.z;
+	float side = projection.m_tangent.z * offsetX - projection.m_tangent.x * offsetZ;
+	float distance = sqrtf(projection.m_distanceSquared);
+
+	projection.m_lateralOffset = (side >= 0.f) ? distance : -distance;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::GetPoseAtDistance(float trackDistance, Vec3& outPosition, Vec3& outTangent) const
+{
+	if (!IsValid())
+	{
+		outPosition = Vec3::ZERO;
+		outTangent = Vec3::ZERO;
+		return;
+	}
+
+	float trackLength = GetTrackLength();
+	trackDistance = fmodf(trackDistance, trackLength);
+	if (trackDistance < 0.f)
+	{
+		trackDistance += trackLength;
+	}
+
+	//Binary search the arc length table for the segment containing the distance
+	uint low = 0;
+	uint high = GetNumSegments() - 1;
+	while (low < high)
+	{
+		uint middle = (low + high + 1) / 2;
+		if (m_cumulativeLengths[middle] <= trackDistance)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	const Vec3& start = m_points[low];
+	const Vec3& end = m_points[low + 1];
+	float segmentLength = m_cumulativeLengths[low + 1] - m_cumulativeLengths[low];
+	float t = (segmentLength > 0.f) ? (trackDistance - m_cumulativeLengths[low]) / segmentLength : 0.f;
+
+	outPosition = Vec3(start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t, start.z + (end.z - start.z) * t);
+
+	if (segmentLength > 0.f)
+	{
+		outTangent = Vec3((end.x - start.x) / segmentLength, (end.y - start.y) / segmentLength, (end.z - start.z) / segmentLength);
+	}
+	else
+	{
+		outTangent = Vec3::ZERO;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackCenterline::DebugRenderCenterline() const
+{
+	if (!IsValid())
+		return;
+
+	CPUMesh lineMesh;
+	for (const Vec3& point : m_points)
+	{
+		CPUMeshAddCube(&lineMesh, AABB3(point - Vec3(0.2f, 0.f, 0.2f), point + Vec3(0.2f, 0.4f, 0.2f)), Rgba::YELLOW);
+	}
+
+	GPUMesh mesh = GPUMesh(g_renderContext);
+	mesh.CreateFromCPUMesh<Vertex_Lit>(&lineMesh, GPU_MEMORY_USAGE_STATIC);
+	g_renderContext->DrawMesh(&mesh);
+}
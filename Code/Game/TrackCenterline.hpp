@@ -0,0 +1,62 @@
+#pragma once
+//Engine Systems
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/TrackSpatialGrid.hpp"
+#include <vector>
+
+class TrackGateTable;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct TrackProjection
+{
+	Vec3				m_closestPoint = Vec3::ZERO;
+	Vec3				m_tangent = Vec3::ZERO;			//Unit direction of travel at the closest point
+	float				m_trackDistance = 0.f;			//Arc length from the first gate along the direction of travel
+	float				m_lateralOffset = 0.f;			//Positive when cross(tangent, offset) points up
+	float				m_distanceSquared = 0.f;
+	uint				m_segmentIndex = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Closed Catmull-Rom spline through the gate positions, baked into a polyline with a cumulative arc length table.
+// Segments are bucketed in a uniform XZ grid so projecting a point only looks at the segments close to it
+//------------------------------------------------------------------------------------------------------------------------------
+class TrackCenterline
+{
+public:
+	TrackCenterline();
+	~TrackCenterline();
+
+	void				BuildFromGates(const TrackGateTable& trackGates, uint samplesPerSpan = 32, float cellSize = 20.f);
+	void				BuildFromControlPoints(const std::vector<Vec3>& controlPoints, uint samplesPerSpan = 32, float cellSize = 20.f);
+	void				Clear();
+
+	bool				IsValid() const;
+	float				GetTrackLength() const;
+	uint				GetNumSegments() const;
+
+	//Projects a world point to the closest point on the centerline
+	TrackProjection		ProjectPoint(const Vec3& point) const;
+	TrackProjection		ProjectPointLinear(const Vec3& point) const;
+
+	//Position and unit tangent at a distance along the track, the distance wraps around the loop
+	void				GetPoseAtDistance(float trackDistance, Vec3& outPosition, Vec3& outTangent) const;
+
+	void				DebugRenderCenterline() const;
+
+private:
+	void				BuildSegmentGrid(float cellSize);
+	void				TestSegment(uint segmentIndex, const Vec3& point, TrackProjection& bestProjection) const;
+	void				FinalizeProjection(const Vec3& point, TrackProjection& projection) const;
+
+	static float		GetSegmentDistanceSquared(uint segmentIndex, const Vec3& point, const void* userData);
+
+private:
+	//Polyline samples, m_points[i] to m_points[i + 1] is segment i. The last point repeats the first to close the loop
+	std::vector<Vec3>	m_points;
+	std::vector<float>	m_cumulativeLengths;
+
+	TrackSpatialGrid	m_segmentGrid;
+};
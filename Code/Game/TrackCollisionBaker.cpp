@@ -0,0 +1,669 @@
+#include "Game/TrackCollisionBaker.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/XMLUtils/XMLUtils.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+//Game Systems
+#include "Game/CookedMeshCache.hpp"
+//Third Party
+#include "ThirdParty/TinyXML2/tinyxml2.h"
+#include "extensions/PxDefaultCpuDispatcher.h"
+#include "extensions/PxDefaultSimulationFilterShader.h"
+#include "extensions/PxDefaultStreams.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <utility>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Engine .mesh files store the axis swap as something like "x y -z". Each output axis picks a source axis and a sign
+struct AxisTransform
+{
+	int		m_sourceAxis[3] = { 0, 1, 2 };
+	float	m_sign[3] = { 1.f, 1.f, 1.f };
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static AxisTransform ParseAxisTransform(const std::string& transformString)
+{
+	AxisTransform transform;
+
+	std::istringstream tokens(transformString);
+	std::string token;
+	int outputAxis = 0;
+	while (tokens >> token && outputAxis < 3)
+	{
+		float sign = 1.f;
+		if (token[0] == '-')
+		{
+			sign = -1.f;
+			token = token.substr(1);
+		}
+
+		if (!token.empty() && token[0] >= 'x' && token[0] <= 'z')
+		{
+			transform.m_sourceAxis[outputAxis] = token[0] - 'x';
+			transform.m_sign[outputAxis] = sign;
+		}
+
+		outputAxis++;
+	}
+
+	return transform;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool IsAxisTransformMirrored(const AxisTransform& transform)
+{
+	//An odd permutation or an odd number of negated axes flips handedness, and with it the triangle winding
+	int numSwaps = 0;
+	for (int axisA = 0; axisA < 3; axisA++)
+	{
+		for (int axisB = axisA + 1; axisB < 3; axisB++)
+		{
+			if (transform.m_sourceAxis[axisA] > transform.m_sourceAxis[axisB])
+			{
+				numSwaps++;
+			}
+		}
+	}
+
+	float determinantSign = (numSwaps % 2 == 0) ? 1.f : -1.f;
+	determinantSign *= transform.m_sign[0] * transform.m_sign[1] * transform.m_sign[2];
+	return determinantSign < 0.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static std::string GetObjPathForCollisionSource(const std::string& sourcePath)
+{
+	//Some entries point straight at an .obj, others at a .mesh that names the .obj in its src attribute
+	std::string extension = (sourcePath.size() > 5) ? sourcePath.substr(sourcePath.size() - 5) : "";
+	if (extension != ".mesh")
+	{
+		return sourcePath;
+	}
+
+	tinyxml2::XMLDocument meshDoc;
+	meshDoc.LoadFile(("Data/Models/" + sourcePath).c_str());
+	if (meshDoc.ErrorID() != tinyxml2::XML_SUCCESS)
+	{
+		return "";
+	}
+
+	return ParseXmlAttribute(*meshDoc.RootElement(), "src", std::string(""));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Obstacles are all one layer, drivable pieces get a layer per tire surface
+static bool IsBakeLayer(eTrackSurfaceType surfaceType, eTireSurface tireSurface)
+{
+	return surfaceType == TRACK_SURFACE_DRIVABLE || tireSurface == TIRE_SURFACE_ROAD;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void CountSceneShapes(PxScene& scene, uint& outNumActors, uint& outNumShapes)
+{
+	outNumActors = scene.getNbActors(PxActorTypeFlag::eRIGID_STATIC);
+	outNumShapes = 0;
+
+	std::vector<PxActor*> actors(outNumActors);
+	if (outNumActors > 0)
+	{
+		scene.getActors(PxActorTypeFlag::eRIGID_STATIC, &actors[0], outNumActors);
+	}
+
+	for (PxActor* actor : actors)
+	{
+		outNumShapes += static_cast<PxRigidActor*>(actor)->getNbShapes();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void ReleaseScratchScene(PxScene* scene, PxDefaultCpuDispatcher* dispatcher)
+{
+	uint numActors = scene->getNbActors(PxActorTypeFlag::eRIGID_STATIC);
+	std::vector<PxActor*> actors(numActors);
+	if (numActors > 0)
+	{
+		scene->getActors(PxActorTypeFlag::eRIGID_STATIC, &actors[0], numActors);
+	}
+
+	for (PxActor* actor : actors)
+	{
+		actor->release();
+	}
+
+	scene->release();
+	dispatcher->release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackCollisionBaker::LoadColliderPieces(const std::string& meshFilePath, std::vector<TrackColliderPiece>& outPieces)
+{
+	tinyxml2::XMLDocument meshDoc;
+	meshDoc.LoadFile(("Data/Models/" + meshFilePath).c_str());
+
+	if (meshDoc.ErrorID() != tinyxml2::XML_SUCCESS)
+	{
+		DebuggerPrintf("\n >> Error loading track mesh file %s", meshFilePath.c_str());
+		return false;
+	}
+
+	//Collision pieces go through the same scale, axis swap and offset as the track mesh they belong to
+	XMLElement* root = meshDoc.RootElement();
+	float scale = ParseXmlAttribute(*root, "scale", 1.f);
+	Vec3 position = ParseXmlAttribute(*root, "position", Vec3::ZERO);
+	AxisTransform axisTransform = ParseAxisTransform(ParseXmlAttribute(*root, "transform", std::string("x y z")));
+	bool flipWinding = IsAxisTransformMirrored(axisTransform) != ParseXmlAttribute(*root, "invert", false);
+
+	outPieces.clear();
+
+	XMLElement* collisionElement = root->FirstChildElement("collision");
+	while (collisionElement != nullptr)
+	{
+		std::string sourcePath = ParseXmlAttribute(*collisionElement, "src", std::string(""));
+		std::string objPath = GetObjPathForCollisionSource(sourcePath);
+
+		TrackColliderPiece piece;
+		piece.m_surfaceType = GetSurfaceTypeForPhysXFlags(ParseXmlAttribute(*collisionElement, "physXFlags", std::string("obstacle")));
+		if (piece.m_surfaceType == TRACK_SURFACE_DRIVABLE)
+		{
+			//Names are resolved here once, nothing at runtime looks at them
+			piece.m_tireSurface = TireSurfaceTable::GetSurfaceForName(ParseXmlAttribute(*collisionElement, "surface", std::string("road")));
+		}
+
+		std::vector<PxVec3> objVertices;
+		if (objPath.empty() || !LoadOBJGeometry("Data/Models/" + objPath, objVertices, piece.m_indices))
+		{
+			DebuggerPrintf("\n >> Skipping track collider %s, could not read its geometry", sourcePath.c_str());
+			collisionElement = collisionElement->NextSiblingElement("collision");
+			continue;
+		}
+
+		piece.m_vertices.reserve(objVertices.size());
+		for (const PxVec3& objVertex : objVertices)
+		{
+			PxVec3 vertex;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				vertex[axis] = objVertex[axisTransform.m_sourceAxis[axis]] * axisTransform.m_sign[axis] * scale;
+			}
+
+			piece.m_vertices.push_back(vertex + PhysXSystem::VecToPxVector(position));
+		}
+
+		if (flipWinding)
+		{
+			for (size_t index = 0; index + 2 < piece.m_indices.size(); index += 3)
+			{
+				std::swap(piece.m_indices[index + 1], piece.m_indices[index + 2]);
+			}
+		}
+
+		outPieces.push_back(piece);
+		collisionElement = collisionElement->NextSiblingElement("collision");
+	}
+
+	return !outPieces.empty();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackCollisionBaker::LoadOBJGeometry(const std::string& objFilePath, std::vector<PxVec3>& outVertices, std::vector<PxU32>& outIndices)
+{
+	std::ifstream readStream(objFilePath);
+	if (!readStream.is_open())
+	{
+		return false;
+	}
+
+	//Only positions and faces matter for collision, faces with more than 3 corners are fanned into triangles
+	std::string line;
+	std::vector<PxU32> faceIndices;
+	while (std::getline(readStream, line))
+	{
+		if (line.size() < 2)
+		{
+			continue;
+		}
+
+		std::istringstream tokens(line);
+		std::string type;
+		tokens >> type;
+
+		if (type == "v")
+		{
+			PxVec3 vertex;
+			tokens >> vertex.x >> vertex.y >> vertex.z;
+			outVertices.push_back(vertex);
+		}
+		else if (type == "f")
+		{
+			faceIndices.clear();
+
+			std::string corner;
+			while (tokens >> corner)
+			{
+				//Corners look like v, v/vt, v//vn or v/vt/vn and can be negative to count back from the last vertex
+				int vertexIndex = atoi(corner.c_str());
+				if (vertexIndex < 0)
+				{
+					vertexIndex += (int)outVertices.size() + 1;
+				}
+
+				faceIndices.push_back((PxU32)(vertexIndex - 1));
+			}
+
+			for (size_t cornerIndex = 2; cornerIndex < faceIndices.size(); cornerIndex++)
+			{
+				outIndices.push_back(faceIndices[0]);
+				outIndices.push_back(faceIndices[cornerIndex - 1]);
+				outIndices.push_back(faceIndices[cornerIndex]);
+			}
+		}
+	}
+
+	return !outVertices.empty() && !outIndices.empty();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackCollisionBaker::BakeMergedCollision(const std::vector<TrackColliderPiece>& pieces, const std::string& bakedFilePath)
+{
+	PxCooking* cooking = g_PxPhysXSystem->GetPhysXCookingModule();
+
+	//BVH34 is the faster midphase for raycasts. Welding stitches the seams where neighbouring pieces share an edge
+	PxCookingParams previousParams = cooking->getParams();
+	PxCookingParams bakeParams = previousParams;
+	bakeParams.midphaseDesc = PxMeshMidPhase::eBVH34;
+	bakeParams.midphaseDesc.mBVH34Desc.numPrimsPerLeaf = 4;
+	bakeParams.meshPreprocessParams |= PxMeshPreprocessingFlag::eWELD_VERTICES;
+	bakeParams.meshWeldTolerance = 0.001f;
+	cooking->setParams(bakeParams);
+
+	bool bakedAnything = false;
+	for (int layerIndex = 0; layerIndex < NUM_TRACK_SURFACE_TYPES * NUM_TIRE_SURFACES; layerIndex++)
+	{
+		eTrackSurfaceType surfaceType = (eTrackSurfaceType)(layerIndex / NUM_TIRE_SURFACES);
+		eTireSurface tireSurface = (eTireSurface)(layerIndex % NUM_TIRE_SURFACES);
+		if (!IsBakeLayer(surfaceType, tireSurface))
+		{
+			continue;
+		}
+
+		std::string cookedFilePath = GetCookedFilePath(bakedFilePath, surfaceType, tireSurface);
+
+		std::vector<PxVec3> vertices;
+		std::vector<PxU32> indices;
+		for (const TrackColliderPiece& piece : pieces)
+		{
+			if (piece.m_surfaceType != surfaceType || (surfaceType == TRACK_SURFACE_DRIVABLE && piece.m_tireSurface != tireSurface))
+			{
+				continue;
+			}
+
+			PxU32 firstVertex = (PxU32)vertices.size();
+			vertices.insert(vertices.end(), piece.m_vertices.begin(), piece.m_vertices.end());
+			for (PxU32 index : piece.m_indices)
+			{
+				indices.push_back(firstVertex + index);
+			}
+		}
+
+		if (indices.empty())
+		{
+			//Nothing of this type on the track, clear out anything baked for it before
+			remove(cookedFilePath.c_str());
+			continue;
+		}
+
+		PxTriangleMeshDesc meshDesc;
+		meshDesc.points.count = (PxU32)vertices.size();
+		meshDesc.points.stride = sizeof(PxVec3);
+		meshDesc.points.data = &vertices[0];
+		meshDesc.triangles.count = (PxU32)(indices.size() / 3);
+		meshDesc.triangles.stride = 3 * sizeof(PxU32);
+		meshDesc.triangles.data = &indices[0];
+
+		PxDefaultFileOutputStream writeStream(cookedFilePath.c_str());
+		PxTriangleMeshCookingResult::Enum result;
+		if (!writeStream.isValid() || !cooking->cookTriangleMesh(meshDesc, writeStream, &result))
+		{
+			DebuggerPrintf("\n >> Failed to cook %s (%s) track collision to %s", GetNameForSurfaceType(surfaceType), TireSurfaceTable::GetNameForSurface(tireSurface), cookedFilePath.c_str());
+			continue;
+		}
+
+		bakedAnything = true;
+	}
+
+	cooking->setParams(previousParams);
+	return bakedAnything;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxRigidStatic* TrackCollisionBaker::CreateMergedTrackActor(const std::string& bakedFilePath, const TireSurfaceTable* tireSurfaces)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	PxRigidStatic* trackActor = nullptr;
+	for (int layerIndex = 0; layerIndex < NUM_TRACK_SURFACE_TYPES * NUM_TIRE_SURFACES; layerIndex++)
+	{
+		eTrackSurfaceType surfaceType = (eTrackSurfaceType)(layerIndex / NUM_TIRE_SURFACES);
+		eTireSurface tireSurface = (eTireSurface)(layerIndex % NUM_TIRE_SURFACES);
+		if (!IsBakeLayer(surfaceType, tireSurface))
+		{
+			continue;
+		}
+
+		PxDefaultFileInputData readStream(GetCookedFilePath(bakedFilePath, surfaceType, tireSurface).c_str());
+		if (!readStream.isValid())
+		{
+			continue;
+		}
+
+		PxTriangleMesh* triangleMesh = physX->createTriangleMesh(readStream);
+		if (triangleMesh == nullptr)
+		{
+			continue;
+		}
+
+		if (trackActor == nullptr)
+		{
+			trackActor = physX->createRigidStatic(PxTransform(PxIdentity));
+		}
+
+		//One shape per surface type keeps the drivable and obstacle filter data apart, and each drivable shape on one tire surface
+		PxShape* shape = PxRigidActorExt::createExclusiveShape(*trackActor, PxTriangleMeshGeometry(triangleMesh), *pxMaterial);
+		SetupFilterDataForSurfaceType(*shape, surfaceType);
+		if (surfaceType == TRACK_SURFACE_DRIVABLE && tireSurfaces != nullptr)
+		{
+			tireSurfaces->ApplySurfaceToShape(*shape, tireSurface);
+		}
+
+		//The shape holds its own reference
+		triangleMesh->release();
+	}
+
+	return trackActor;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint TrackCollisionBaker::CreatePieceActors(const std::vector<TrackColliderPiece>& pieces, PxScene& scene)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	uint numActors = 0;
+	for (const TrackColliderPiece& piece : pieces)
+	{
+		PxConvexMeshDesc convexDesc;
+		convexDesc.points.count = (PxU32)piece.m_vertices.size();
+		convexDesc.points.stride = sizeof(PxVec3);
+		convexDesc.points.data = &piece.m_vertices[0];
+		convexDesc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
+
+		PxConvexMesh* convexMesh = CookedMeshCache::GetOrCookConvexMesh(convexDesc);
+		if (convexMesh == nullptr)
+		{
+			continue;
+		}
+
+		PxRigidStatic* pieceActor = physX->createRigidStatic(PxTransform(PxIdentity));
+		PxShape* shape = PxRigidActorExt::createExclusiveShape(*pieceActor, PxConvexMeshGeometry(convexMesh), *pxMaterial);
+		SetupFilterDataForSurfaceType(*shape, piece.m_surfaceType);
+		convexMesh->release();
+
+		scene.addActor(*pieceActor);
+		numActors++;
+	}
+
+	return numActors;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC std::string TrackCollisionBaker::GetBakedFilePathForMesh(const std::string& meshFilePath)
+{
+	std::string baseName = meshFilePath;
+	size_t extensionStart = baseName.rfind(".mesh");
+	if (extensionStart != std::string::npos)
+	{
+		baseName = baseName.substr(0, extensionStart);
+	}
+
+	return "Data/Models/" + baseName + "_Baked";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC std::string TrackCollisionBaker::GetCookedFilePath(const std::string& bakedFilePath, eTrackSurfaceType surfaceType, eTireSurface tireSurface)
+{
+	//Road keeps the name from before there were tire surfaces so existing bakes still load
+	if (surfaceType == TRACK_SURFACE_DRIVABLE && tireSurface != TIRE_SURFACE_ROAD)
+	{
+		return bakedFilePath + "_" + GetNameForSurfaceType(surfaceType) + "_" + TireSurfaceTable::GetNameForSurface(tireSurface) + ".pxtrimesh";
+	}
+
+	return bakedFilePath + "_" + GetNameForSurfaceType(surfaceType) + ".pxtrimesh";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC eTrackSurfaceType TrackCollisionBaker::GetSurfaceTypeForPhysXFlags(const std::string& physXFlags)
+{
+	if (physXFlags == "drivableSurface")
+	{
+		return TRACK_SURFACE_DRIVABLE;
+	}
+
+	return TRACK_SURFACE_OBSTACLE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* TrackCollisionBaker::GetNameForSurfaceType(eTrackSurfaceType surfaceType)
+{
+	switch (surfaceType)
+	{
+	case TRACK_SURFACE_DRIVABLE:
+		return "drivableSurface";
+	case TRACK_SURFACE_OBSTACLE:
+	default:
+		return "obstacle";
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TrackCollisionBaker::SetupFilterDataForSurfaceType(PxShape& shape, eTrackSurfaceType surfaceType)
+{
+	PxFilterData simFilterData;
+	PxFilterData qryFilterData;
+
+	if (surfaceType == TRACK_SURFACE_DRIVABLE)
+	{
+		simFilterData = PxFilterData(COLLISION_FLAG_DRIVABLE_OBSTACLE, COLLISION_FLAG_DRIVABLE_OBSTACLE_AGAINST, 0, 0);
+		setupDrivableSurface(qryFilterData);
+	}
+	else
+	{
+		simFilterData = PxFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_OBSTACLE_AGAINST, 0, 0);
+		setupNonDrivableSurface(qryFilterData);
+	}
+
+	shape.setSimulationFilterData(simFilterData);
+	shape.setQueryFilterData(qryFilterData);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TrackCollisionBaker::RegisterConsoleCommands()
+{
+	g_eventSystem->SubscribeEventCallBackFn("BakeTrackCollision", Command_BakeTrackCollision);
+	g_eventSystem->SubscribeEventCallBackFn("BenchmarkTrackCollision", Command_BenchmarkTrackCollision);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackCollisionBaker::Command_BakeTrackCollision(EventArgs& args)
+{
+	std::string key = "mesh";
+	std::string defaultValue = "ScaledTrack/ScaledTrack1CollidersOnly.mesh";
+	std::string meshFilePath = args.GetValue(key, defaultValue);
+
+	double startTime = GetCurrentTimeSeconds();
+
+	std::vector<TrackColliderPiece> pieces;
+	if (!LoadColliderPieces(meshFilePath, pieces))
+	{
+		g_devConsole->PrintString(Rgba::RED, Stringf("BakeTrackCollision could not read any colliders from %s", meshFilePath.c_str()));
+		return false;
+	}
+
+	uint numTriangles[NUM_TRACK_SURFACE_TYPES * NUM_TIRE_SURFACES] = { 0 };
+	for (const TrackColliderPiece& piece : pieces)
+	{
+		eTireSurface tireSurface = (piece.m_surfaceType == TRACK_SURFACE_DRIVABLE) ? piece.m_tireSurface : TIRE_SURFACE_ROAD;
+		numTriangles[piece.m_surfaceType * NUM_TIRE_SURFACES + tireSurface] += (uint)(piece.m_indices.size() / 3);
+	}
+
+	std::string bakedFilePath = GetBakedFilePathForMesh(meshFilePath);
+	if (!BakeMergedCollision(pieces, bakedFilePath))
+	{
+		g_devConsole->PrintString(Rgba::RED, Stringf("BakeTrackCollision failed to cook %s", bakedFilePath.c_str()));
+		return false;
+	}
+
+	double bakeTime = GetCurrentTimeSeconds() - startTime;
+	g_devConsole->PrintString(Rgba::ORGANIC_BLUE, Stringf("Baked %u collider pieces from %s in %.1f ms", (uint)pieces.size(), meshFilePath.c_str(), bakeTime * 1000.0));
+	for (int layerIndex = 0; layerIndex < NUM_TRACK_SURFACE_TYPES * NUM_TIRE_SURFACES; layerIndex++)
+	{
+		if (numTriangles[layerIndex] > 0)
+		{
+			eTrackSurfaceType surfaceType = (eTrackSurfaceType)(layerIndex / NUM_TIRE_SURFACES);
+			eTireSurface tireSurface = (eTireSurface)(layerIndex % NUM_TIRE_SURFACES);
+			std::string cookedFilePath = GetCookedFilePath(bakedFilePath, surfaceType, tireSurface);
+			g_devConsole->PrintString(Rgba::WHITE, Stringf("%s (%s): %u triangles -> %s", GetNameForSurfaceType(surfaceType), TireSurfaceTable::GetNameForSurface(tireSurface), numTriangles[layerIndex], cookedFilePath.c_str()));
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackCollisionBaker::Command_BenchmarkTrackCollision(EventArgs& args)
+{
+	std::string key = "mesh";
+	std::string defaultValue = "ScaledTrack/ScaledTrack1CollidersOnly.mesh";
+	std::string meshFilePath = args.GetValue(key, defaultValue);
+
+	key = "rays";
+	defaultValue = "10000";
+	uint numRays = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	//Before: parse every piece and give each its own actor, the way the mesh loader does it. The pieces go through the cooked
+	//mesh cache, so only the first run pays for cooking them
+	double startTime = GetCurrentTimeSeconds();
+	std::vector<TrackColliderPiece> pieces;
+	if (!LoadColliderPieces(meshFilePath, pieces) || numRays == 0)
+	{
+		g_devConsole->PrintString(Rgba::RED, Stringf("BenchmarkTrackCollision needs colliders in %s and rays greater than 0", meshFilePath.c_str()));
+		return false;
+	}
+	double parseTime = GetCurrentTimeSeconds() - startTime;
+
+	std::string bakedFilePath = GetBakedFilePathForMesh(meshFilePath);
+	PxDefaultFileInputData bakedCheck(GetCookedFilePath(bakedFilePath, TRACK_SURFACE_OBSTACLE).c_str());
+	if (!bakedCheck.isValid())
+	{
+		BakeMergedCollision(pieces, bakedFilePath);
+	}
+
+	//Each layout goes in its own scene so nothing else on the track skews the counts
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxSceneDesc sceneDesc(physX->getTolerancesScale());
+	sceneDesc.gravity = PxVec3(0.f, -9.81f, 0.f);
+	sceneDesc.filterShader = PxDefaultSimulationFilterShader;
+
+	PxDefaultCpuDispatcher* pieceDispatcher = PxDefaultCpuDispatcherCreate(1);
+	sceneDesc.cpuDispatcher = pieceDispatcher;
+	PxScene* pieceScene = physX->createScene(sceneDesc);
+
+	startTime = GetCurrentTimeSeconds();
+	CreatePieceActors(pieces, *pieceScene);
+	double pieceLoadTime = parseTime + GetCurrentTimeSeconds() - startTime;
+
+	//After: read the cooked meshes straight off disk
+	PxDefaultCpuDispatcher* mergedDispatcher = PxDefaultCpuDispatcherCreate(1);
+	sceneDesc.cpuDispatcher = mergedDispatcher;
+	PxScene* mergedScene = physX->createScene(sceneDesc);
+
+	startTime = GetCurrentTimeSeconds();
+	PxRigidStatic* mergedActor = CreateMergedTrackActor(bakedFilePath);
+	if (mergedActor != nullptr)
+	{
+		mergedScene->addActor(*mergedActor);
+	}
+	double mergedLoadTime = GetCurrentTimeSeconds() - startTime;
+
+	//Rays straight down over the track bounds, like a wheel raycast from above
+	PxBounds3 trackBounds = PxBounds3::empty();
+	for (const TrackColliderPiece& piece : pieces)
+	{
+		for (const PxVec3& vertex : piece.m_vertices)
+		{
+			trackBounds.include(vertex);
+		}
+	}
+
+	std::vector<PxVec3> rayOrigins;
+	rayOrigins.reserve(numRays);
+	for (uint rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		float x = g_RNG->GetRandomFloatInRange(trackBounds.minimum.x, trackBounds.maximum.x);
+		float z = g_RNG->GetRandomFloatInRange(trackBounds.minimum.z, trackBounds.maximum.z);
+		rayOrigins.push_back(PxVec3(x, trackBounds.maximum.y + 1.f, z));
+	}
+
+	PxVec3 rayDirection = PxVec3(0.f, -1.f, 0.f);
+	float rayLength = trackBounds.maximum.y - trackBounds.minimum.y + 2.f;
+
+	PxScene* scenes[2] = { pieceScene, mergedScene };
+	double rayTimes[2] = { 0.0, 0.0 };
+	uint numHits[2] = { 0, 0 };
+	for (int sceneIndex = 0; sceneIndex < 2; sceneIndex++)
+	{
+		//First query builds the pruning structure, keep that out of the per ray cost
+		PxRaycastBuffer warmupHit;
+		scenes[sceneIndex]->raycast(rayOrigins[0], rayDirection, rayLength, warmupHit);
+
+		startTime = GetCurrentTimeSeconds();
+		for (uint rayIndex = 0; rayIndex < numRays; rayIndex++)
+		{
+			PxRaycastBuffer hit;
+			if (scenes[sceneIndex]->raycast(rayOrigins[rayIndex], rayDirection, rayLength, hit))
+			{
+				numHits[sceneIndex]++;
+			}
+		}
+		rayTimes[sceneIndex] = GetCurrentTimeSeconds() - startTime;
+	}
+
+	uint pieceActors = 0;
+	uint pieceShapes = 0;
+	uint mergedActors = 0;
+	uint mergedShapes = 0;
+	CountSceneShapes(*pieceScene, pieceActors, pieceShapes);
+	CountSceneShapes(*mergedScene, mergedActors, mergedShapes);
+
+	double pieceRayNs = rayTimes[0] * 1e9 / (double)numRays;
+	double mergedRayNs = rayTimes[1] * 1e9 / (double)numRays;
+
+	g_devConsole->PrintString(Rgba::ORGANIC_BLUE, Stringf("Track collision benchmark: %s, %u pieces, %u rays", meshFilePath.c_str(), (uint)pieces.size(), numRays));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Actors: pieces %u (%u shapes), merged %u (%u shapes)", pieceActors, pieceShapes, mergedActors, mergedShapes));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Load:   pieces %.1f ms, merged %.1f ms", pieceLoadTime * 1000.0, mergedLoadTime * 1000.0));
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Ray:    pieces %.1f ns/ray, merged %.1f ns/ray (%.1fx)", pieceRayNs, mergedRayNs, pieceRayNs / mergedRayNs));
+
+	//Pieces are cooked as convex hulls of the source geometry, so they can cover slightly more than the merged triangles do
+	g_devConsole->PrintString(Rgba::WHITE, Stringf("Hits:   pieces %u, merged %u", numHits[0], numHits[1]));
+
+	ReleaseScratchScene(pieceScene, pieceDispatcher);
+	ReleaseScratchScene(mergedScene, mergedDispatcher);
+	return true;
+}
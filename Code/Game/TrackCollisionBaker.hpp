@@ -0,0 +1,71 @@
+#pragma once
+//Engine Systems
+#include "Engine/Core/EventSystems.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/TireSurfaceTable.hpp"
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Surface type comes from the physXFlags on each <collision> entry of a track .mesh file
+//------------------------------------------------------------------------------------------------------------------------------
+enum eTrackSurfaceType
+{
+	TRACK_SURFACE_OBSTACLE = 0,
+	TRACK_SURFACE_DRIVABLE,
+
+	NUM_TRACK_SURFACE_TYPES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One collider piece in track space, already scaled and axis swapped the same way as the track render mesh
+//------------------------------------------------------------------------------------------------------------------------------
+struct TrackColliderPiece
+{
+	std::vector<PxVec3>		m_vertices;
+	std::vector<PxU32>		m_indices;
+	eTrackSurfaceType		m_surfaceType = TRACK_SURFACE_OBSTACLE;
+	eTireSurface			m_tireSurface = TIRE_SURFACE_ROAD;		//From the surface attribute, only drivable pieces use it
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Offline step that merges all the static collider pieces of a track into one cooked triangle mesh per surface type
+// (BVH34 midphase), plus the runtime side that loads them back as a single static actor. Drivable pieces are split further
+// by tire surface so each shape carries exactly one surface.
+// The pieces used to become one actor each, which is a lot of broadphase entries and scene query leaves for mostly walls
+//------------------------------------------------------------------------------------------------------------------------------
+class TrackCollisionBaker
+{
+public:
+	//Reads the <collision> entries of a track .mesh file and the OBJ geometry behind each. Paths are relative to Data/Models
+	static bool				LoadColliderPieces(const std::string& meshFilePath, std::vector<TrackColliderPiece>& outPieces);
+
+	//Welds every piece of the same surface type into one triangle mesh and writes the cooked stream for each surface type
+	static bool				BakeMergedCollision(const std::vector<TrackColliderPiece>& pieces, const std::string& bakedFilePath);
+
+	//Runtime side, one static actor with a triangle mesh shape per surface type. Returns nullptr if nothing was baked.
+	//Without a surface table every drivable shape stays on the default material, which drives as road
+	static PxRigidStatic*	CreateMergedTrackActor(const std::string& bakedFilePath, const TireSurfaceTable* tireSurfaces = nullptr);
+
+	//The old layout with one static convex actor per piece, only used by the benchmark to compare against
+	static uint				CreatePieceActors(const std::vector<TrackColliderPiece>& pieces, PxScene& scene);
+
+	static std::string		GetBakedFilePathForMesh(const std::string& meshFilePath);
+	static std::string		GetCookedFilePath(const std::string& bakedFilePath, eTrackSurfaceType surfaceType, eTireSurface tireSurface = TIRE_SURFACE_ROAD);
+	static eTrackSurfaceType	GetSurfaceTypeForPhysXFlags(const std::string& physXFlags);
+	static const char*		GetNameForSurfaceType(eTrackSurfaceType surfaceType);
+	static void				SetupFilterDataForSurfaceType(PxShape& shape, eTrackSurfaceType surfaceType);
+
+	static void				RegisterConsoleCommands();
+
+	//BakeTrackCollision mesh=ScaledTrack/ScaledTrack1CollidersOnly.mesh
+	static bool				Command_BakeTrackCollision(EventArgs& args);
+
+	//BenchmarkTrackCollision mesh=ScaledTrack/ScaledTrack1CollidersOnly.mesh rays=10000. Builds the per piece and the merged
+	//layout in their own scratch scenes and prints actor count, load time and raycast cost for both. Bakes first if needed
+	static bool				Command_BenchmarkTrackCollision(EventArgs& args);
+
+private:
+	static bool				LoadOBJGeometry(const std::string& objFilePath, std::vector<PxVec3>& outVertices, std::vector<PxU32>& outIndices);
+};
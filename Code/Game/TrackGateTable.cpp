@@ -0,0 +1,401 @@
+#include "Game/TrackGateTable.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+//Third party
+#include "ThirdParty/TinyXML2/tinyxml2.h"
+#include <math.h>
+#include <utility>
+#include <emmintrin.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static float GetGateDistanceSquared(uint gateIndex, const Vec3& point, const void* userData)
+{
+	return reinterpret_cast<const TrackGateTable*>(userData)->GetDistanceSquaredToGate(gateIndex, point);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackGateTable::TrackGateTable()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackGateTable::~TrackGateTable()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TrackGateTable::LoadFromXMLFile(const std::string& filePath)
+{
+	tinyxml2::XMLDocument gateDoc;
+	gateDoc.LoadFile(filePath.c_str());
+
+	if (gateDoc.ErrorID() != tinyxml2::XML_SUCCESS)
+	{
+		DebuggerPrintf("\n >> Error loading track gate file %s", filePath.c_str());
+		return false;
+	}
+
+	Clear();
+
+	XMLElement* root = gateDoc.RootElement();
+	float cellSize = ParseXmlAttribute(*root, "gridCellSize", 25.f);
+
+	//Gates are listed in the order the cars have to cross them
+	XMLElement* gateElement = root->FirstChildElement("Gate");
+	while (gateElement != nullptr)
+	{
+		Vec3 position = ParseXmlAttribute(*gateElement, "position", Vec3::ZERO);
+		Vec3 halfExtents = ParseXmlAttribute(*gateElement, "halfExtents", Vec3::ZERO);
+		AddGate(position, halfExtents);
+
+		gateElement = gateElement->NextSiblingElement("Gate");
+	}
+
+	BuildSpatialGrid(cellSize);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackGateTable::AddGate(const Vec3& gatePosition, const Vec3& gateHalfExtents)
+{
+	m_positionX.push_back(gatePosition.x);
+	m_positionY.push_back(gatePosition.y);
+	m_positionZ.push_back(gatePosition.z);
+
+	m_minsX.push_back(gatePosition.x - gateHalfExtents.x);
+	m_minsY.push_back(gatePosition.y - gateHalfExtents.y);
+	m_minsZ.push_back(gatePosition.z - gateHalfExtents.z);
+
+	m_maxsX.push_back(gatePosition.x + gateHalfExtents.x);
+	m_maxsY.push_back(gatePosition.y + gateHalfExtents.y);
+	m_maxsZ.push_back(gatePosition.z + gateHalfExtents.z);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackGateTable::Clear()
+{
+	m_positionX.clear();
+	m_positionY.clear();
+	m_positionZ.clear();
+
+	m_minsX.clear();
+	m_minsY.clear();
+	m_minsZ.clear();
+
+	m_maxsX.clear();
+	m_maxsY.clear();
+	m_maxsZ.clear();
+
+	m_grid.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackGateTable::BuildSpatialGrid(float cellSize)
+{
+	uint numGates = GetNumGates();
+	std::vector<SpatialGridItemBounds> gateBounds(numGates);
+	for (uint gateIndex = 0; gateIndex < numGates; gateIndex++)
+	{
+		gateBounds[gateIndex].m_minX = m_minsX[gateIndex];
+		gateBounds[gateIndex].m_minZ = m_minsZ[gateIndex];
+		gateBounds[gateIndex].m_maxX = m_maxsX[gateIndex];
+		gateBounds[gateIndex].m_maxZ = m_maxsZ[gateIndex];
+	}
+
+	m_grid.Build(gateBounds, cellSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint TrackGateTable::GetNumGates() const
+{
+	return (uint)m_positionX.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec3 TrackGateTable::GetGatePosition(uint gateIndex) const
+{
+	return Vec3(m_positionX[gateIndex], m_positionY[gateIndex], m_positionZ[gateIndex]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec3 TrackGateTable::GetGateMins(uint gateIndex) const
+{
+	return Vec3(m_minsX[gateIndex], m_minsY[gateIndex], m_minsZ[gateIndex]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec3 TrackGateTable::GetGateMaxs(uint gateIndex) const
+{
+	return Vec3(m_maxsX[gateIndex], m_maxsY[gateIndex], m_maxsZ[gateIndex]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TrackGateTable::HasSegmentCrossedGate(uint gateIndex, const Vec3& segmentStart, const Vec3& segmentEnd, float* outEntryFraction) const
+{
+	//Slab test for the segment against the gate box. A fast car can move further than the depth of the gate between 2 checks
+	//so we test the whole path travelled instead of only where the car ended up
+	const float start[3] = { segmentStart.x, segmentStart.y, segmentStart.z };
+	const float delta[3] = { segmentEnd.x - segmentStart.x, segmentEnd.y - segmentStart.y, segmentEnd.z - segmentStart.z };
+	const float boxMins[3] = { m_minsX[gateIndex], m_minsY[gateIndex], m_minsZ[gateIndex] };
+	const float boxMaxs[3] = { m_maxsX[gateIndex], m_maxsY[gateIndex], m_maxsZ[gateIndex] };
+
+	float entryFraction = 0.f;
+	float exitFraction = 1.f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (fabsf(delta[axis]) < 1e-6f)
+		{
+			//Segment is parallel to this slab, it has to start inside it
+			if (start[axis] < boxMins[axis] || start[axis] > boxMaxs[axis])
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		float oneOverDelta = 1.f / delta[axis];
+		float slabEntry = (boxMins[axis] - start[axis]) * oneOverDelta;
+		float slabExit = (boxMaxs[axis] - start[axis]) * oneOverDelta;
+
+		if (slabEntry > slabExit)
+		{
+			std::swap(slabEntry, slabExit);
+		}
+
+		entryFraction = (slabEntry > entryFraction) ? slabEntry : entryFraction;
+		exitFraction = (slabExit < exitFraction) ? slabExit : exitFraction;
+
+		if (entryFraction > exitFraction)
+		{
+			return false;
+		}
+	}
+
+	if (outEntryFraction != nullptr)
+	{
+		*outEntryFraction = entryFraction;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static inline __m128 SelectSSE(const __m128& mask, const __m128& ifTrue, const __m128& ifFalse)
+{
+	return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Slab test for one axis on 4 lanes. Narrows entry/exit fractions in place
+static inline void SlabTestAxisSSE(const __m128& start, const __m128& end, const __m128& boxMin, const __m128& boxMax, __m128& entryFraction, __m128& exitFraction)
+{
+	const __m128 epsilon = _mm_set1_ps(1e-6f);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 farAway = _mm_set1_ps(1e30f);
+	const __m128 one = _mm_set1_ps(1.f);
+
+	__m128 delta = _mm_sub_ps(end, start);
+	__m128 oneOverDelta = _mm_div_ps(one, delta);
+
+	__m128 slabA = _mm_mul_ps(_mm_sub_ps(boxMin, start), oneOverDelta);
+	__m128 slabB = _mm_mul_ps(_mm_sub_ps(boxMax, start), oneOverDelta);
+	__m128 slabEntry = _mm_min_ps(slabA, slabB);
+	__m128 slabExit = _mm_max_ps(slabA, slabB);
+
+	//Lanes where the segment is parallel to the slab either always overlap it or never do
+	__m128 isParallel = _mm_cmplt_ps(_mm_and_ps(delta, absMask), epsilon);
+	__m128 startsInside = _mm_and_ps(_mm_cmpge_ps(start, boxMin), _mm_cmple_ps(start, boxMax));
+	__m128 parallelEntry = SelectSSE(startsInside, _mm_sub_ps(_mm_setzero_ps(), farAway), farAway);
+	__m128 parallelExit = SelectSSE(startsInside, farAway, _mm_sub_ps(_mm_setzero_ps(), farAway));
+
+	slabEntry = SelectSSE(isParallel, parallelEntry, slabEntry);
+	slabExit = SelectSSE(isParallel, parallelExit, slabExit);
+
+	entryFraction = _mm_max_ps(entryFraction, slabEntry);
+	exitFraction = _mm_min_ps(exitFraction, slabExit);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint64_t TrackGateTable::TestSegmentsAgainstGates(const Vec3* segmentStarts, const Vec3* segmentEnds, const uint* gateIndices, uint numSegments, float* outEntryFractions) const
+{
+	ASSERT_RECOVERABLE(numSegments <= MAX_GATE_TEST_BATCH, "Too many segments for a single gate test batch");
+	if (numSegments > MAX_GATE_TEST_BATCH)
+	{
+		numSegments = MAX_GATE_TEST_BATCH;
+	}
+
+	uint64_t crossedMask = 0;
+
+	for (uint batchStart = 0; batchStart < numSegments; batchStart += 4)
+	{
+		//Gather 4 lanes worth of data. Each car has its own next gate so the gate bounds are gathered per lane
+		//Unused lanes get an inverted box that can never be hit
+		alignas(16) float startX[4], startY[4], startZ[4];
+		alignas(16) float endX[4], endY[4], endZ[4];
+		alignas(16) float minX[4], minY[4], minZ[4];
+		alignas(16) float maxX[4], maxY[4], maxZ[4];
+
+		for (uint lane = 0; lane < 4; lane++)
+		{
+			uint segmentIndex = batchStart + lane;
+			if (segmentIndex < numSegments)
+			{
+				uint gateIndex = gateIndices[segmentIndex];
+
+				startX[lane] = segmentStarts[segmentIndex].x;
+				startY[lane] = segmentStarts[segmentIndex].y;
+				startZ[lane] = segmentStarts[segmentIndex].z;
+
+				endX[lane] = segmentEnds[segmentIndex].x;
+				endY[lane] = segmentEnds[segmentIndex].y;
+				endZ[lane] = segmentEnds[segmentIndex].z;
+
+				minX[lane] = m_minsX[gateIndex];
+				minY[lane] = m_minsY[gateIndex];
+				minZ[lane] = m_minsZ[gateIndex];
+
+				maxX[lane] = m_maxsX[gateIndex];
+				maxY[lane] = m_maxsY[gateIndex];
+				maxZ[lane] = m_maxsZ[gateIndex];
+			}
+			else
+			{
+				startX[lane] = startY[lane] = startZ[lane] = 0.f;
+				endX[lane] = endY[lane] = endZ[lane] = 0.f;
+				minX[lane] = minY[lane] = minZ[lane] = 1.f;
+				maxX[lane] = maxY[lane] = maxZ[lane] = -1.f;
+			}
+		}
+
+		__m128 entryFraction = _mm_setzero_ps();
+		__m128 exitFraction = _mm_set1_ps(1.f);
+
+		SlabTestAxisSSE(_mm_load_ps(startX), _mm_load_ps(endX), _mm_load_ps(minX), _mm_load_ps(maxX), entryFraction, exitFraction);
+		SlabTestAxisSSE(_mm_load_ps(startY), _mm_load_ps(endY), _mm_load_ps(minY), _mm_load_ps(maxY), entryFraction, exitFraction);
+		SlabTestAxisSSE(_mm_load_ps(startZ), _mm_load_ps(endZ), _mm_load_ps(minZ), _mm_load_ps(maxZ), entryFraction, exitFraction);
+
+		int laneMask = _mm_movemask_ps(_mm_cmple_ps(entryFraction, exitFraction));
+		crossedMask |= ((uint64_t)laneMask << batchStart);
+
+		if (outEntryFractions != nullptr)
+		{
+			alignas(16) float laneEntryFractions[4];
+			_mm_store_ps(laneEntryFractions, entryFraction);
+
+			for (uint lane = 0; lane < 4 && batchStart + lane < numSegments; lane++)
+			{
+				outEntryFractions[batchStart + lane] = laneEntryFractions[lane];
+			}
+		}
+	}
+
+	//Clear any bits from padding lanes
+	if (numSegments < MAX_GATE_TEST_BATCH)
+	{
+		crossedMask &= (((uint64_t)1 << numSegments) - 1);
+	}
+
+	return crossedMask;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackGateTable::FindGateContainingPoint(const Vec3& point) const
+{
+	if (m_grid.IsEmpty())
+	{
+		return FindGateContainingPointLinear(point);
+	}
+
+	//Outside the grid means outside every gate
+	int cellIndex = m_grid.GetCellIndexForPoint(point);
+	if (cellIndex == -1)
+	{
+		return -1;
+	}
+
+	//Every gate overlapping this point is in the point's cell
+	for (uint listIndex = m_grid.GetCellListStart((uint)cellIndex); listIndex < m_grid.GetCellListEnd((uint)cellIndex); listIndex++)
+	{
+		uint gateIndex = m_grid.GetItemIndex(listIndex);
+		if (IsPointInsideGate(gateIndex, point))
+		{
+			return (int)gateIndex;
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackGateTable::FindNearestGate(const Vec3& point) const
+{
+	if (m_grid.IsEmpty())
+	{
+		return FindNearestGateLinear(point);
+	}
+
+	//Gates are stored in every cell they touch so a gate is found in the first ring that overlaps its bounds
+	return m_grid.FindNearestItem(point, GetGateDistanceSquared, this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackGateTable::FindGateContainingPointLinear(const Vec3& point) const
+{
+	uint numGates = GetNumGates();
+	for (uint gateIndex = 0; gateIndex < numGates; gateIndex++)
+	{
+		if (IsPointInsideGate(gateIndex, point))
+		{
+			return (int)gateIndex;
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackGateTable::FindNearestGateLinear(const Vec3& point) const
+{
+	int nearestGate = -1;
+	float nearestDistanceSquared = 0.f;
+
+	uint numGates = GetNumGates();
+	for (uint gateIndex = 0; gateIndex < numGates; gateIndex++)
+	{
+		float distanceSquared = GetDistanceSquaredToGate(gateIndex, point);
+		if (nearestGate == -1 || distanceSquared < nearestDistanceSquared)
+		{
+			nearestGate = (int)gateIndex;
+			nearestDistanceSquared = distanceSquared;
+		}
+	}
+
+	return nearestGate;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TrackGateTable::IsPointInsideGate(uint gateIndex, const Vec3& point) const
+{
+	return	point.x >= m_minsX[gateIndex] && point.x <= m_maxsX[gateIndex] &&
+			point.y >= m_minsY[gateIndex] && point.y <= m_maxsY[gateIndex] &&
+			point.z >= m_minsZ[gateIndex] && point.z <= m_maxsZ[gateIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float TrackGateTable::GetDistanceSquaredToGate(uint gateIndex, const Vec3& point) const
+{
+	//Distance to the closest point on the gate box, 0 when inside
+	float closestX = (point.x < m_minsX[gateIndex]) ? m_minsX[gateIndex] : ((point.x > m_maxsX[gateIndex]) ? m_maxsX[gateIndex] : point.x);
+	float closestY = (point.y < m_minsY[gateIndex]) ? m_minsY[gateIndex] : ((point.y > m_maxsY[gateIndex]) ? m_maxsY[gateIndex] : point.y);
+	float closestZ = (point.z < m_minsZ[gateIndex]) ? m_minsZ[gateIndex] : ((point.z > m_maxsZ[gateIndex]) ? m_maxsZ[gateIndex] : point.z);
+
+	float deltaX = point.x - closestX;
+	float deltaY = point.y - closestY;
+	float deltaZ = point.z - closestZ;
+
+	return deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+}
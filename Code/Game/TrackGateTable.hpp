@@ -0,0 +1,72 @@
+#pragma once
+//Engine Systems
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/TrackSpatialGrid.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Maximum number of segments we can test in one batch, each segment gets one bit in the crossing mask
+constexpr uint MAX_GATE_TEST_BATCH = 64;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The gates for a track. Built once when the track is set up and shared by every car on that track.
+// Bounds are stored per component (SoA) so the batch test can load the same component for 4 cars into one SIMD register
+//------------------------------------------------------------------------------------------------------------------------------
+class TrackGateTable
+{
+public:
+	TrackGateTable();
+	~TrackGateTable();
+
+	bool				LoadFromXMLFile(const std::string& filePath);
+	void				AddGate(const Vec3& gatePosition, const Vec3& gateHalfExtents);
+	void				Clear();
+
+	//Uniform grid on the XZ plane over the gate bounds. Has to be rebuilt after gates are added
+	void				BuildSpatialGrid(float cellSize);
+
+	uint				GetNumGates() const;
+	Vec3				GetGatePosition(uint gateIndex) const;
+	Vec3				GetGateMins(uint gateIndex) const;
+	Vec3				GetGateMaxs(uint gateIndex) const;
+
+	//Scalar test for a single segment against a single gate. The entry fraction is where along the segment it entered the gate
+	bool				HasSegmentCrossedGate(uint gateIndex, const Vec3& segmentStart, const Vec3& segmentEnd, float* outEntryFraction = nullptr) const;
+
+	//Tests segment i against gate gateIndices[i] for all segments, returns a mask with bit i set if segment i crossed its gate
+	//If outEntryFractions is given it gets the entry fraction for every segment that crossed
+	uint64_t			TestSegmentsAgainstGates(const Vec3* segmentStarts, const Vec3* segmentEnds, const uint* gateIndices, uint numSegments, float* outEntryFractions = nullptr) const;
+
+	//Spatial queries using the grid, both return -1 if there is no result
+	int					FindGateContainingPoint(const Vec3& point) const;
+	int					FindNearestGate(const Vec3& point) const;
+
+	//Brute force versions of the queries above, kept for the benchmark and for validating the grid
+	int					FindGateContainingPointLinear(const Vec3& point) const;
+	int					FindNearestGateLinear(const Vec3& point) const;
+
+	//Distance to the closest point on the gate box, 0 when inside
+	float				GetDistanceSquaredToGate(uint gateIndex, const Vec3& point) const;
+
+private:
+	bool				IsPointInsideGate(uint gateIndex, const Vec3& point) const;
+
+private:
+	std::vector<float>	m_positionX;
+	std::vector<float>	m_positionY;
+	std::vector<float>	m_positionZ;
+
+	std::vector<float>	m_minsX;
+	std::vector<float>	m_minsY;
+	std::vector<float>	m_minsZ;
+
+	std::vector<float>	m_maxsX;
+	std::vector<float>	m_maxsY;
+	std::vector<float>	m_maxsZ;
+
+	TrackSpatialGrid	m_grid;
+};
@@ -0,0 +1,157 @@
+#include "Game/TrackRespawnPoses.hpp"
+//Engine Systems
+#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+//Game Systems
+#include "Game/TrackCenterline.hpp"
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//How far above and below the centerline we look for the road, and the steepest ground a car is put down on
+constexpr float RESPAWN_PROBE_HEIGHT = 20.f;
+constexpr float RESPAWN_PROBE_DEPTH = 40.f;
+constexpr float RESPAWN_MIN_GROUND_NORMAL_Y = 0.7f;
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackRespawnPoses::TrackRespawnPoses()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackRespawnPoses::~TrackRespawnPoses()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackRespawnPoses::BuildFromCenterline(const TrackCenterline& centerline, const PxScene* groundScene, float spacing, float cellSize)
+{
+	Clear();
+
+	float trackLength = centerline.GetTrackLength();
+	if (!centerline.IsValid() || spacing <= 0.f || trackLength <= 0.f)
+	{
+		return;
+	}
+
+	uint numPoses = (uint)(trackLength / spacing);
+	numPoses = (numPoses == 0) ? 1 : numPoses;
+	m_poses.reserve(numPoses);
+
+	for (uint poseIndex = 0; poseIndex < numPoses; poseIndex++)
+	{
+		RespawnPose pose;
+		pose.m_trackDistance = (float)poseIndex * spacing;
+
+		Vec3 tangent;
+		centerline.GetPoseAtDistance(pose.m_trackDistance, pose.m_position, tangent);
+
+		//Cars respawn upright so only the heading on the XZ plane matters
+		float flatLength = sqrtf(tangent.x * tangent.x + tangent.z * tangent.z);
+		if (flatLength > 0.f)
+		{
+			pose.m_forward = Vec3(tangent.x / flatLength, 0.f, tangent.z / flatLength);
+		}
+		else
+		{
+			pose.m_forward = Vec3(0.f, 0.f, 1.f);
+		}
+
+		if (groundScene != nullptr && !SnapPoseToGround(*groundScene, pose))
+		{
+			continue;
+		}
+
+		m_poses.push_back(pose);
+	}
+
+	if (m_poses.size() < numPoses)
+	{
+		DebuggerPrintf("\n Dropped %u of %u respawn poses with no drivable ground under them", numPoses - (uint)m_poses.size(), numPoses);
+	}
+
+	if (m_poses.empty())
+	{
+		return;
+	}
+
+	//Poses are points so their bounds are just the position
+	std::vector<SpatialGridItemBounds> poseBounds(m_poses.size());
+	for (uint poseIndex = 0; poseIndex < (uint)m_poses.size(); poseIndex++)
+	{
+		poseBounds[poseIndex].m_minX = poseBounds[poseIndex].m_maxX = m_poses[poseIndex].m_position.x;
+		poseBounds[poseIndex].m_minZ = poseBounds[poseIndex].m_maxZ = m_poses[poseIndex].m_position.z;
+	}
+
+	m_grid.Build(poseBounds, cellSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackRespawnPoses::Clear()
+{
+	m_poses.clear();
+	m_grid.Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint TrackRespawnPoses::GetNumPoses() const
+{
+	return (uint)m_poses.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const RespawnPose& TrackRespawnPoses::GetPose(uint poseIndex) const
+{
+	return m_poses[poseIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackRespawnPoses::FindNearestPose(const Vec3& point) const
+{
+	return m_grid.FindNearestItem(point, GetPoseDistanceSquared, this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TrackRespawnPoses::SnapPoseToGround(const PxScene& groundScene, RespawnPose& pose)
+{
+	//Only static drivable shapes count, cars and obstacles are dynamic and walls are undrivable. Touch hits come back in no
+	//particular order so keep the closest one below the probe origin
+	PxVec3 probeOrigin = PhysXSystem::VecToPxVector(pose.m_position) + PxVec3(0.f, RESPAWN_PROBE_HEIGHT, 0.f);
+	PxRaycastBufferN<8> hitBuffer;
+	PxQueryFilterData filterData(PxQueryFlag::eSTATIC | PxQueryFlag::eNO_BLOCK);
+	groundScene.raycast(probeOrigin, PxVec3(0.f, -1.f, 0.f), RESPAWN_PROBE_HEIGHT + RESPAWN_PROBE_DEPTH, hitBuffer, PxHitFlag::eDEFAULT, filterData);
+
+	const PxRaycastHit* groundHit = nullptr;
+	for (PxU32 hitIndex = 0; hitIndex < hitBuffer.nbTouches; hitIndex++)
+	{
+		const PxRaycastHit& hit = hitBuffer.touches[hitIndex];
+		if ((hit.shape->getQueryFilterData().word3 & DRIVABLE_SURFACE) == 0 || hit.normal.y < RESPAWN_MIN_GROUND_NORMAL_Y)
+		{
+			continue;
+		}
+
+		if (groundHit == nullptr || hit.distance < groundHit->distance)
+		{
+			groundHit = &hit;
+		}
+	}
+
+	if (groundHit == nullptr)
+	{
+		return false;
+	}
+
+	pose.m_position.y = groundHit->position.y;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC float TrackRespawnPoses::GetPoseDistanceSquared(uint poseIndex, const Vec3& point, const void* userData)
+{
+	const Vec3& position = reinterpret_cast<const TrackRespawnPoses*>(userData)->m_poses[poseIndex].m_position;
+
+	float deltaX = point.x - position.x;
+	float deltaY = point.y - position.y;
+	float deltaZ = point.z - position.z;
+	return deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+}
@@ -0,0 +1,48 @@
+#pragma once
+//Engine Systems
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/TrackSpatialGrid.hpp"
+#include <vector>
+
+class TrackCenterline;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct RespawnPose
+{
+	Vec3				m_position = Vec3::ZERO;
+	Vec3				m_forward = Vec3::ZERO;		//Unit direction of travel on the XZ plane
+	float				m_trackDistance = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Safe respawn poses sampled along the track centerline. The centerline only follows the gate positions, so when a scene is
+// given every pose is snapped down onto drivable geometry and poses with nothing drivable under them are dropped.
+// Poses are bucketed in a uniform XZ grid so finding the nearest one to a stuck car is a handful of cell lookups
+//------------------------------------------------------------------------------------------------------------------------------
+class TrackRespawnPoses
+{
+public:
+	TrackRespawnPoses();
+	~TrackRespawnPoses();
+
+	//Without a ground scene the poses stay on the centerline. The track colliders have to be in the scene before this is called
+	void				BuildFromCenterline(const TrackCenterline& centerline, const PxScene* groundScene = nullptr, float spacing = 5.f, float cellSize = 20.f);
+	void				Clear();
+
+	uint				GetNumPoses() const;
+	const RespawnPose&	GetPose(uint poseIndex) const;
+
+	//Returns -1 if there are no poses
+	int					FindNearestPose(const Vec3& point) const;
+
+private:
+	static bool			SnapPoseToGround(const PxScene& groundScene, RespawnPose& pose);
+	static float		GetPoseDistanceSquared(uint poseIndex, const Vec3& point, const void* userData);
+
+private:
+	std::vector<RespawnPose>	m_poses;
+	TrackSpatialGrid			m_grid;
+};
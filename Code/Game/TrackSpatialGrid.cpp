@@ -0,0 +1,240 @@
+#include "Game/TrackSpatialGrid.hpp"
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackSpatialGrid::TrackSpatialGrid()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackSpatialGrid::~TrackSpatialGrid()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackSpatialGrid::Build(const std::vector<SpatialGridItemBounds>& itemBounds, float cellSize)
+{
+	Clear();
+
+	uint numItems = (uint)itemBounds.size();
+	if (numItems == 0 || cellSize <= 0.f)
+	{
+		return;
+	}
+
+	//Fit the grid around all the item bounds
+	m_cellSize = cellSize;
+	float gridMaxX = itemBounds[0].m_maxX;
+	float gridMaxZ = itemBounds[0].m_maxZ;
+	m_gridMinX = itemBounds[0].m_minX;
+	m_gridMinZ = itemBounds[0].m_minZ;
+	for (const SpatialGridItemBounds& bounds : itemBounds)
+	{
+		m_gridMinX = (bounds.m_minX < m_gridMinX) ? bounds.m_minX : m_gridMinX;
+		m_gridMinZ = (bounds.m_minZ < m_gridMinZ) ? bounds.m_minZ : m_gridMinZ;
+		gridMaxX = (bounds.m_maxX > gridMaxX) ? bounds.m_maxX : gridMaxX;
+		gridMaxZ = (bounds.m_maxZ > gridMaxZ) ? bounds.m_maxZ : gridMaxZ;
+	}
+
+	m_numCellsX = (int)((gridMaxX - m_gridMinX) / cellSize) + 1;
+	m_numCellsZ = (int)((gridMaxZ - m_gridMinZ) / cellSize) + 1;
+	uint numCells = (uint)(m_numCellsX * m_numCellsZ);
+
+	//Count pass then fill pass so every cell's item list is contiguous in one array
+	std::vector<uint> cellCounts(numCells, 0);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+		{
+			m_cellStarts.resize(numCells + 1);
+			m_cellStarts[0] = 0;
+			for (uint cellIndex = 0; cellIndex < numCells; cellIndex++)
+			{
+				m_cellStarts[cellIndex + 1] = m_cellStarts[cellIndex] + cellCounts[cellIndex];
+				cellCounts[cellIndex] = m_cellStarts[cellIndex];
+			}
+
+			m_cellItemIndices.resize(m_cellStarts[numCells]);
+		}
+
+		for (uint itemIndex = 0; itemIndex < numItems; itemIndex++)
+		{
+			const SpatialGridItemBounds& bounds = itemBounds[itemIndex];
+			int maxCellX = GetCellCoordX(bounds.m_maxX);
+			int maxCellZ = GetCellCoordZ(bounds.m_maxZ);
+
+			for (int cellZ = GetCellCoordZ(bounds.m_minZ); cellZ <= maxCellZ; cellZ++)
+			{
+				for (int cellX = GetCellCoordX(bounds.m_minX); cellX <= maxCellX; cellX++)
+				{
+					uint cellIndex = (uint)(cellZ * m_numCellsX + cellX);
+					if (pass == 0)
+					{
+						cellCounts[cellIndex]++;
+					}
+					else
+					{
+						m_cellItemIndices[cellCounts[cellIndex]++] = itemIndex;
+					}
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackSpatialGrid::Clear()
+{
+	m_cellSize = 0.f;
+	m_numCellsX = 0;
+	m_numCellsZ = 0;
+	m_cellStarts.clear();
+	m_cellItemIndices.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TrackSpatialGrid::IsEmpty() const
+{
+	return m_numCellsX == 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+float TrackSpatialGrid::GetCellSize() const
+{
+	return m_cellSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackSpatialGrid::GetCellIndexForPoint(const Vec3& point) const
+{
+	if (IsEmpty())
+	{
+		return -1;
+	}
+
+	float localX = (point.x - m_gridMinX) / m_cellSize;
+	float localZ = (point.z - m_gridMinZ) / m_cellSize;
+	if (localX < 0.f || localZ < 0.f || localX >= (float)m_numCellsX || localZ >= (float)m_numCellsZ)
+	{
+		return -1;
+	}
+
+	return (int)localZ * m_numCellsX + (int)localX;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint TrackSpatialGrid::GetCellListStart(uint cellIndex) const
+{
+	return m_cellStarts[cellIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint TrackSpatialGrid::GetCellListEnd(uint cellIndex) const
+{
+	return m_cellStarts[cellIndex + 1];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint TrackSpatialGrid::GetItemIndex(uint listIndex) const
+{
+	return m_cellItemIndices[listIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackSpatialGrid::FindNearestItem(const Vec3& point, SpatialGridDistanceFn distanceFn, const void* userData, float* outDistanceSquared) const
+{
+	if (IsEmpty())
+	{
+		return -1;
+	}
+
+	int centerX = GetCellCoordX(point.x);
+	int centerZ = GetCellCoordZ(point.z);
+
+	int nearestItem = -1;
+	float nearestDistanceSquared = 0.f;
+	int maxRing = (m_numCellsX > m_numCellsZ) ? m_numCellsX : m_numCellsZ;
+
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		for (int cellZ = centerZ - ring; cellZ <= centerZ + ring; cellZ++)
+		{
+			if (cellZ < 0 || cellZ >= m_numCellsZ)
+				continue;
+
+			//Inner rows of the ring only have the two cells on its left and right edges
+			bool isEdgeRow = (cellZ == centerZ - ring || cellZ == centerZ + ring);
+			int stepX = (isEdgeRow || ring == 0) ? 1 : ring * 2;
+
+			for (int cellX = centerX - ring; cellX <= centerX + ring; cellX += stepX)
+			{
+				if (cellX < 0 || cellX >= m_numCellsX)
+					continue;
+
+				uint cellIndex = (uint)(cellZ * m_numCellsX + cellX);
+				for (uint listIndex = m_cellStarts[cellIndex]; listIndex < m_cellStarts[cellIndex + 1]; listIndex++)
+				{
+					uint itemIndex = m_cellItemIndices[listIndex];
+					float distanceSquared = distanceFn(itemIndex, point, userData);
+					if (nearestItem == -1 || distanceSquared < nearestDistanceSquared)
+					{
+						nearestItem = (int)itemIndex;
+						nearestDistanceSquared = distanceSquared;
+					}
+				}
+			}
+		}
+
+		//Once the ring covers the whole grid there is nothing left to visit
+		if (centerX - ring <= 0 && centerX + ring >= m_numCellsX - 1 && centerZ - ring <= 0 && centerZ + ring >= m_numCellsZ - 1)
+		{
+			break;
+		}
+
+		if (nearestItem != -1)
+		{
+			//Anything we haven't visited is at least this far away on the XZ plane
+			float searchedMinX = m_gridMinX + (float)(centerX - ring) * m_cellSize;
+			float searchedMaxX = m_gridMinX + (float)(centerX + ring + 1) * m_cellSize;
+			float searchedMinZ = m_gridMinZ + (float)(centerZ - ring) * m_cellSize;
+			float searchedMaxZ = m_gridMinZ + (float)(centerZ + ring + 1) * m_cellSize;
+
+			float unsearchedDistance = point.x - searchedMinX;
+			unsearchedDistance = (searchedMaxX - point.x < unsearchedDistance) ? searchedMaxX - point.x : unsearchedDistance;
+			unsearchedDistance = (point.z - searchedMinZ < unsearchedDistance) ? point.z - searchedMinZ : unsearchedDistance;
+			unsearchedDistance = (searchedMaxZ - point.z < unsearchedDistance) ? searchedMaxZ - point.z : unsearchedDistance;
+
+			if (unsearchedDistance > 0.f && nearestDistanceSquared <= unsearchedDistance * unsearchedDistance)
+			{
+				break;
+			}
+		}
+	}
+
+	if (outDistanceSquared != nullptr)
+	{
+		*outDistanceSquared = nearestDistanceSquared;
+	}
+
+	return nearestItem;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackSpatialGrid::GetCellCoordX(float x) const
+{
+	int cellX = (int)floorf((x - m_gridMinX) / m_cellSize);
+	cellX = (cellX < 0) ? 0 : cellX;
+	cellX = (cellX >= m_numCellsX) ? m_numCellsX - 1 : cellX;
+	return cellX;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int TrackSpatialGrid::GetCellCoordZ(float z) const
+{
+	int cellZ = (int)floorf((z - m_gridMinZ) / m_cellSize);
+	cellZ = (cellZ < 0) ? 0 : cellZ;
+	cellZ = (cellZ >= m_numCellsZ) ? m_numCellsZ - 1 : cellZ;
+	return cellZ;
+}
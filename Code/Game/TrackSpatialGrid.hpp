@@ -0,0 +1,60 @@
+#pragma once
+//Engine Systems
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SpatialGridItemBounds
+{
+	float				m_minX = 0.f;
+	float				m_minZ = 0.f;
+	float				m_maxX = 0.f;
+	float				m_maxZ = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Distance squared from the point to item itemIndex, userData is whatever was passed to FindNearestItem
+typedef float (*SpatialGridDistanceFn)(uint itemIndex, const Vec3& point, const void* userData);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Uniform grid on the XZ plane shared by the gate table, the centerline and the respawn poses. Items go in every cell their
+// XZ bounds touch and the cell lists are stored flat, so the lists for cell i are m_cellItemIndices[m_cellStarts[i]] to
+// m_cellItemIndices[m_cellStarts[i + 1]]. The grid only holds indices, the owner keeps the items
+//------------------------------------------------------------------------------------------------------------------------------
+class TrackSpatialGrid
+{
+public:
+	TrackSpatialGrid();
+	~TrackSpatialGrid();
+
+	//Fits the grid around the bounds. An empty list or a cell size of 0 leaves the grid empty
+	void				Build(const std::vector<SpatialGridItemBounds>& itemBounds, float cellSize);
+	void				Clear();
+
+	bool				IsEmpty() const;
+	float				GetCellSize() const;
+
+	//Returns -1 if the point is outside the grid
+	int					GetCellIndexForPoint(const Vec3& point) const;
+	uint				GetCellListStart(uint cellIndex) const;
+	uint				GetCellListEnd(uint cellIndex) const;
+	uint				GetItemIndex(uint listIndex) const;
+
+	//Searches outward one ring of cells at a time until nothing unvisited could be closer than the best item found.
+	//Exact as long as the distance is never less than the XZ distance to the item's bounds. Returns -1 if the grid is empty
+	int					FindNearestItem(const Vec3& point, SpatialGridDistanceFn distanceFn, const void* userData, float* outDistanceSquared = nullptr) const;
+
+private:
+	int					GetCellCoordX(float x) const;
+	int					GetCellCoordZ(float z) const;
+
+private:
+	float				m_cellSize = 0.f;
+	float				m_gridMinX = 0.f;
+	float				m_gridMinZ = 0.f;
+	int					m_numCellsX = 0;
+	int					m_numCellsZ = 0;
+	std::vector<uint>	m_cellStarts;
+	std::vector<uint>	m_cellItemIndices;
+};
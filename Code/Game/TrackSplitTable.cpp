@@ -0,0 +1,111 @@
+#include "Game/TrackSplitTable.hpp"
+//Engine Systems
+#include "Engine/Core/FileUtils.hpp"
+#include <fstream>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackSplitTable::TrackSplitTable()
+{
+	Clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+TrackSplitTable::~TrackSplitTable()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackSplitTable::LoadFromTextFile(const std::string& filePath)
+{
+	Clear();
+
+	//File is one split per line in gate order, the last line is the lap time
+	std::ifstream readStream(filePath);
+	if (!readStream.is_open())
+	{
+		DebuggerPrintf("\n No best split file found at %s", filePath.c_str());
+		return;
+	}
+
+	std::string line;
+	while (std::getline(readStream, line))
+	{
+		if (line.empty())
+		{
+			continue;
+		}
+
+		m_splits.push_back(atof(line.c_str()));
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackSplitTable::SaveToTextFile(const std::string& filePath) const
+{
+	std::ofstream* writeStream = CreateFileWriteBuffer(filePath);
+
+	for (uint splitIndex = 0; splitIndex < GetNumSplits(); splitIndex++)
+	{
+		std::string writeString = std::to_string(m_splits[splitIndex]) + "\n";
+		writeStream->write(writeString.c_str(), writeString.length());
+	}
+
+	writeStream->flush();
+	writeStream->close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void TrackSplitTable::Clear()
+{
+	m_splits.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint TrackSplitTable::GetNumSplits() const
+{
+	return (uint)m_splits.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TrackSplitTable::HasSplitForGate(uint gateIndex) const
+{
+	return gateIndex < GetNumSplits();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double TrackSplitTable::GetSplitForGate(uint gateIndex) const
+{
+	return m_splits[gateIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double TrackSplitTable::GetLapTime() const
+{
+	if (m_splits.empty())
+	{
+		return 0.0;
+	}
+
+	return m_splits.back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool TrackSplitTable::SubmitLapIfFaster(const double* lapSplits, uint numSplits)
+{
+	if (numSplits == 0)
+	{
+		return false;
+	}
+
+	//A table with a different gate count belongs to an older version of the track, let the new lap replace it
+	bool isSameLayout = (numSplits == GetNumSplits());
+	if (isSameLayout && lapSplits[numSplits - 1] >= GetLapTime())
+	{
+		return false;
+	}
+
+	m_splits.assign(lapSplits, lapSplits + numSplits);
+	return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Best lap splits for a track. Split i is the lap time when gate i was crossed on the best lap, one split per gate so the last
+// split is always the lap time. Loaded once per track, the lookup per gate is a single array read
+//------------------------------------------------------------------------------------------------------------------------------
+class TrackSplitTable
+{
+public:
+	TrackSplitTable();
+	~TrackSplitTable();
+
+	void				LoadFromTextFile(const std::string& filePath);
+	void				SaveToTextFile(const std::string& filePath) const;
+	void				Clear();
+
+	uint				GetNumSplits() const;
+	bool				HasSplitForGate(uint gateIndex) const;
+	double				GetSplitForGate(uint gateIndex) const;
+	double				GetLapTime() const;
+
+	//Replaces the table if the lap is faster than the one stored. Returns true if the table changed
+	bool				SubmitLapIfFaster(const double* lapSplits, uint numSplits);
+
+private:
+	std::vector<double>	m_splits;
+};
@@ -0,0 +1,583 @@
+#include "Game/TuningEvaluator.hpp"
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/XMLUtils/XMLUtils.hpp"
+#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
+//Game Systems
+#include "Game/TrackCenterline.hpp"
+#include "Game/TrackCollisionBaker.hpp"
+#include "Game/TrackGateTable.hpp"
+//Third Party
+#include "ThirdParty/TinyXML2/tinyxml2.h"
+#include "ThirdParty/PhysX/include/vehicle/PxVehicleUtil.h"
+#include "extensions/PxDefaultStreams.h"
+#include <fstream>
+#include <math.h>
+#include <mutex>
+#include <stdlib.h>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Parameter set names come straight from the sweep file, so a comma or quote in one mustn't shift the columns after it
+static std::string QuoteCSVField(const std::string& field)
+{
+	std::string quotedField = "\"";
+	for (char character : field)
+	{
+		if (character == '"')
+		{
+			quotedField += '"';
+		}
+		quotedField += character;
+	}
+	quotedField += '"';
+	return quotedField;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Shared by the sweep's worker threads. Everything but the next set index and the results is read only while they run
+//------------------------------------------------------------------------------------------------------------------------------
+struct TuningSweepWork
+{
+	const std::vector<const XMLElement*>*	m_parameterSets = nullptr;
+	const TrackCenterline*					m_centerline = nullptr;
+	const TuningInputProfile*				m_profile = nullptr;
+	const std::string*						m_bakedTrackPath = nullptr;
+	const TireSurfaceTable*					m_tireSurfaces = nullptr;
+	eTireSurface							m_groundSurface = TIRE_SURFACE_ROAD;
+
+	std::mutex								m_setupLock;
+	size_t									m_nextSetIndex = 0;
+	std::vector<TuningResult>*				m_results = nullptr;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Same drivable ground the game puts under the track, the road itself has no collider
+static void AddDrivableGroundBox(PxScene& scene, const TireSurfaceTable& tireSurfaces, eTireSurface groundSurface)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxMaterial* pxMaterial = g_PxPhysXSystem->GetDefaultPxMaterial();
+
+	const float boxHalfHeight = 0.05f;
+	const float boxXZ = 1000.0f;
+	PxRigidStatic* ground = physX->createRigidStatic(PxTransform(PxVec3(0.f, boxHalfHeight, 0.f), PxQuat(PxIdentity)));
+	PxShape* shape = PxRigidActorExt::createExclusiveShape(*ground, PxBoxGeometry(PxVec3(boxXZ, boxHalfHeight, boxXZ)), *pxMaterial);
+
+	shape->setSimulationFilterData(PxFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_WHEEL, PxPairFlag::eMODIFY_CONTACTS | PxPairFlag::eDETECT_CCD_CONTACT, 0));
+
+	PxFilterData qryFilterData;
+	setupDrivableSurface(qryFilterData);
+	shape->setQueryFilterData(qryFilterData);
+	tireSurfaces.ApplySurfaceToShape(*shape, groundSurface);
+
+	scene.addActor(*ground);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TuningEvaluator::RunSweep(const std::string& sweepFilePath, const std::string& csvFilePath, uint numThreads, std::string& outSummary)
+{
+	tinyxml2::XMLDocument sweepDoc;
+	sweepDoc.LoadFile(sweepFilePath.c_str());
+
+	if (sweepDoc.ErrorID() != tinyxml2::XML_SUCCESS)
+	{
+		outSummary = Stringf("Couldn't load the tuning sweep %s", sweepFilePath.c_str());
+		return false;
+	}
+
+	XMLElement* root = sweepDoc.RootElement();
+	std::string trackMeshPath = ParseXmlAttribute(*root, "trackCollision", std::string("ScaledTrack/ScaledTrack1CollidersOnly.mesh"));
+	std::string trackGatesPath = ParseXmlAttribute(*root, "trackGates", std::string("Data/Gameplay/TrackGates.xml"));
+	std::string tireSurfacesPath = ParseXmlAttribute(*root, "tireSurfaces", std::string("Data/Gameplay/TireSurfaces.xml"));
+	eTireSurface groundSurface = TireSurfaceTable::GetSurfaceForName(ParseXmlAttribute(*root, "groundSurface", std::string("road")));
+
+	TuningInputProfile profile;
+	XMLElement* profileElement = root->FirstChildElement("InputProfile");
+	if (profileElement != nullptr)
+	{
+		LoadInputProfile(*profileElement, profile);
+	}
+
+	//The driver follows the same centerline the race uses for positions and respawns
+	TrackGateTable trackGates;
+	if (!trackGates.LoadFromXMLFile(trackGatesPath))
+	{
+		outSummary = Stringf("Couldn't load the track gates %s", trackGatesPath.c_str());
+		return false;
+	}
+
+	TrackCenterline centerline;
+	centerline.BuildFromGates(trackGates);
+	if (!centerline.IsValid())
+	{
+		outSummary = Stringf("The track gates in %s don't make a centerline", trackGatesPath.c_str());
+		return false;
+	}
+
+	//Every run loads the merged walls, so make sure they are baked before the first run
+	std::string bakedTrackPath = TrackCollisionBaker::GetBakedFilePathForMesh(trackMeshPath);
+	PxDefaultFileInputData bakedCheck(TrackCollisionBaker::GetCookedFilePath(bakedTrackPath, TRACK_SURFACE_OBSTACLE).c_str());
+	if (!bakedCheck.isValid())
+	{
+		std::vector<TrackColliderPiece> pieces;
+		if (!TrackCollisionBaker::LoadColliderPieces(trackMeshPath, pieces) || !TrackCollisionBaker::BakeMergedCollision(pieces, bakedTrackPath))
+		{
+			outSummary = Stringf("Couldn't bake the track collision for %s", trackMeshPath.c_str());
+			return false;
+		}
+	}
+
+	//Same surfaces and grip as the game. Every run only reads the table
+	TireSurfaceTable tireSurfaces;
+	tireSurfaces.LoadFromXMLFile(tireSurfacesPath);
+	tireSurfaces.Startup();
+
+	std::vector<const XMLElement*> parameterSets;
+	const XMLElement* parameterSet = root->FirstChildElement("ParameterSet");
+	while (parameterSet != nullptr)
+	{
+		parameterSets.push_back(parameterSet);
+		parameterSet = parameterSet->NextSiblingElement("ParameterSet");
+	}
+
+	if (numThreads == 0)
+	{
+		numThreads = std::thread::hardware_concurrency();
+	}
+	if (numThreads == 0)
+	{
+		numThreads = 1;
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+
+	//Results go in their parameter set's slot so the CSV keeps the file's order whichever run finishes first
+	std::vector<TuningResult> results(parameterSets.size());
+
+	TuningSweepWork work;
+	work.m_parameterSets = &parameterSets;
+	work.m_centerline = &centerline;
+	work.m_profile = &profile;
+	work.m_bakedTrackPath = &bakedTrackPath;
+	work.m_tireSurfaces = &tireSurfaces;
+	work.m_groundSurface = groundSurface;
+	work.m_results = &results;
+
+	if (numThreads > parameterSets.size())
+	{
+		numThreads = (uint)parameterSets.size();
+	}
+
+	std::vector<std::thread> workerThreads;
+	for (uint threadIndex = 0; threadIndex < numThreads; threadIndex++)
+	{
+		workerThreads.push_back(std::thread(RunSweepWorker, &work));
+	}
+
+	for (std::thread& workerThread : workerThreads)
+	{
+		workerThread.join();
+	}
+
+	double sweepTime = GetCurrentTimeSeconds() - startTime;
+	tireSurfaces.Shutdown();
+
+	if (!WriteResultsCSV(csvFilePath, results))
+	{
+		outSummary = Stringf("Couldn't write the tuning results to %s", csvFilePath.c_str());
+		return false;
+	}
+
+	uint numLapsCompleted = 0;
+	for (const TuningResult& result : results)
+	{
+		numLapsCompleted += (result.m_status == TUNING_RUN_LAP_COMPLETE) ? 1 : 0;
+	}
+
+	outSummary = Stringf("Evaluated %u parameter sets on %u threads in %.1f s, %u completed a lap. Results in %s", (uint)results.size(), numThreads, sweepTime, numLapsCompleted, csvFilePath.c_str());
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TuningEvaluator::RunSweepWorker(TuningSweepWork* work)
+{
+	for (;;)
+	{
+		size_t setIndex = 0;
+		TuningRun* run = nullptr;
+		{
+			//Runs are made one at a time, the engine builds every vehicle in the game scene before we move it
+			std::lock_guard<std::mutex> lock(work->m_setupLock);
+			if (work->m_nextSetIndex >= work->m_parameterSets->size())
+			{
+				return;
+			}
+
+			setIndex = work->m_nextSetIndex++;
+			run = CreateRun(*(*work->m_parameterSets)[setIndex], *work->m_centerline, *work->m_profile, *work->m_bakedTrackPath, *work->m_tireSurfaces, work->m_groundSurface);
+		}
+
+		//Each run only touches its own scene, the centerline and the profile are read only
+		SimulateRun(run, work->m_centerline, work->m_profile);
+
+		{
+			std::lock_guard<std::mutex> lock(work->m_setupLock);
+			(*work->m_results)[setIndex] = run->m_result;
+			DestroyRun(run);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TuningEvaluator::RegisterConsoleCommands()
+{
+	g_eventSystem->SubscribeEventCallBackFn("EvaluateTuning", Command_EvaluateTuning);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TuningEvaluator::Command_EvaluateTuning(EventArgs& args)
+{
+	std::string key = "sets";
+	std::string defaultValue = "Data/Gameplay/TuningSweep.xml";
+	std::string sweepFilePath = args.GetValue(key, defaultValue);
+
+	key = "out";
+	defaultValue = "Data/Gameplay/TuningResults.csv";
+	std::string csvFilePath = args.GetValue(key, defaultValue);
+
+	key = "threads";
+	defaultValue = "0";
+	uint numThreads = (uint)atoi(args.GetValue(key, defaultValue).c_str());
+
+	//Blocks the frame until the whole sweep is done, use the tuningSweep command line for anything big
+	std::string summary;
+	bool succeeded = RunSweep(sweepFilePath, csvFilePath, numThreads, summary);
+	g_devConsole->PrintString(succeeded ? Rgba::ORGANIC_BLUE : Rgba::RED, summary);
+
+	return succeeded;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC const char* TuningEvaluator::GetNameForRunStatus(eTuningRunStatus status)
+{
+	switch (status)
+	{
+	case TUNING_RUN_LAP_COMPLETE:	return "lap";
+	case TUNING_RUN_TIMED_OUT:		return "timeout";
+	case TUNING_RUN_STUCK:			return "stuck";
+	case TUNING_RUN_FLIPPED:		return "flipped";
+	default:						return "unknown";
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC TuningRun* TuningEvaluator::CreateRun(const XMLElement& parameterSet, const TrackCenterline& centerline, const TuningInputProfile& profile, const std::string& bakedTrackPath, const TireSurfaceTable& tireSurfaces, eTireSurface groundSurface)
+{
+	PxPhysics* physX = g_PxPhysXSystem->GetPhysXSDK();
+	PxScene* gameScene = g_PxPhysXSystem->GetPhysXScene();
+
+	TuningRun* run = new TuningRun();
+	run->m_result.m_name = ParseXmlAttribute(parameterSet, "name", std::string("Unnamed"));
+
+	//Start from the saved simulation settings and the tool defaults, the set only overrides what it lists
+	run->m_carTool.LoadSimulationSettings();
+	run->m_carTool.LoadParameterSet(parameterSet);
+
+	//Filtering and contact modification have to match the game scene or the wheels would collide with the ground.
+	//No dispatcher workers, the run's own thread does all the simulation work
+	PxSceneDesc sceneDesc(physX->getTolerancesScale());
+	sceneDesc.gravity = gameScene->getGravity();
+	sceneDesc.filterShader = gameScene->getFilterShader();
+	sceneDesc.filterShaderData = gameScene->getFilterShaderData();
+	sceneDesc.filterShaderDataSize = gameScene->getFilterShaderDataSize();
+	sceneDesc.contactModifyCallback = gameScene->getContactModifyCallback();
+	sceneDesc.ccdContactModifyCallback = gameScene->getCCDContactModifyCallback();
+	sceneDesc.flags = gameScene->getFlags();
+	run->m_dispatcher = PxDefaultCpuDispatcherCreate(0);
+	sceneDesc.cpuDispatcher = run->m_dispatcher;
+	run->m_scene = physX->createScene(sceneDesc);
+
+	AddDrivableGroundBox(*run->m_scene, tireSurfaces, groundSurface);
+	PxRigidStatic* trackActor = TrackCollisionBaker::CreateMergedTrackActor(bakedTrackPath, &tireSurfaces);
+	if (trackActor != nullptr)
+	{
+		run->m_scene->addActor(*trackActor);
+	}
+
+	//The engine puts new vehicles in the game scene, move it over to the run's scene
+	run->m_vehicle = run->m_carTool.MakeNewCar();
+	PxRigidDynamic* vehicleActor = run->m_vehicle->getRigidDynamicActor();
+	gameScene->removeActor(*vehicleActor);
+
+	Vec3 startPosition;
+	Vec3 startTangent;
+	centerline.GetPoseAtDistance(profile.m_startDistance, startPosition, startTangent);
+
+	//Vehicle forward is +Z so the yaw comes from the tangent
+	PxTransform startTransform;
+	startTransform.p = PhysXSystem::VecToPxVector(startPosition + Vec3(0.f, 1.f, 0.f));
+	startTransform.q = PxQuat(atan2f(startTangent.x, startTangent.z), PxVec3(0.f, 1.f, 0.f));
+	vehicleActor->setGlobalPose(startTransform);
+	run->m_scene->addActor(*vehicleActor);
+
+	run->m_vehicle->mDriveDynData.setUseAutoGears(true);
+	run->m_vehicle->mDriveDynData.forceGearChange(PxVehicleGearsData::eFIRST);
+
+	run->m_vehicleManager.SetScene(run->m_scene);
+	run->m_vehicleManager.SetTireFrictionPairs(tireSurfaces.GetFrictionPairs());
+	//Runs are already spread over the sweep's threads, so each run steps its one vehicle on the thread it is on
+	run->m_vehicleManager.Startup(0);
+	run->m_carTool.ApplySimulationSettings(run->m_vehicleManager);
+
+	return run;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TuningEvaluator::DestroyRun(TuningRun* run)
+{
+	run->m_vehicleManager.Shutdown();
+
+	PxRigidDynamic* vehicleActor = run->m_vehicle->getRigidDynamicActor();
+	run->m_scene->removeActor(*vehicleActor);
+	vehicleActor->release();
+	run->m_vehicle->release();
+
+	//Only the ground and the track are left
+	uint numActors = run->m_scene->getNbActors(PxActorTypeFlag::eRIGID_STATIC);
+	std::vector<PxActor*> actors(numActors);
+	if (numActors > 0)
+	{
+		run->m_scene->getActors(PxActorTypeFlag::eRIGID_STATIC, &actors[0], numActors);
+	}
+
+	for (PxActor* actor : actors)
+	{
+		actor->release();
+	}
+
+	run->m_scene->release();
+	run->m_dispatcher->release();
+
+	delete run;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TuningEvaluator::SimulateRun(TuningRun* run, const TrackCenterline* centerline, const TuningInputProfile* profile)
+{
+	double startTime = GetCurrentTimeSeconds();
+
+	const float tickTime = 1.f / profile->m_tickRate;
+	const uint maxTicks = (uint)(profile->m_maxLapSeconds * profile->m_tickRate);
+	const float trackLength = centerline->GetTrackLength();
+	const float radiansToDegrees = 180.f / PxPi;
+
+	PxVehicleDrive4W* vehicle = run->m_vehicle;
+	PxRigidDynamic* vehicleActor = vehicle->getRigidDynamicActor();
+	PxVehicleWheels* vehicles[1] = { vehicle };
+
+	float maxSteer = vehicle->mWheelsSimData.getWheelData(PxVehicleDrive4WWheelOrder::eFRONT_LEFT).mMaxSteer;
+	float lastTrackDistance = centerline->ProjectPoint(PhysXSystem::PxVectorToVec(vehicleActor->getGlobalPose().p)).m_trackDistance;
+	float lapProgress = 0.f;
+	float progressAtLastCheck = 0.f;
+	float timeWithoutProgress = 0.f;
+	float timeFlipped = 0.f;
+	float lateralOffsetSum = 0.f;
+
+	TuningResult& result = run->m_result;
+	result.m_status = TUNING_RUN_TIMED_OUT;
+
+	uint tickIndex = 0;
+	for (; tickIndex < maxTicks; tickIndex++)
+	{
+		PxTransform pose = vehicleActor->getGlobalPose();
+		TrackProjection projection = centerline->ProjectPoint(PhysXSystem::PxVectorToVec(pose.p));
+
+		//Progress along the loop, wrapped so crossing the start line doesn't look like driving a lap backwards
+		float deltaDistance = projection.m_trackDistance - lastTrackDistance;
+		if (deltaDistance > trackLength * 0.5f)
+		{
+			deltaDistance -= trackLength;
+		}
+		else if (deltaDistance < -trackLength * 0.5f)
+		{
+			deltaDistance += trackLength;
+		}
+		lapProgress += deltaDistance;
+		lastTrackDistance = projection.m_trackDistance;
+
+		if (lapProgress >= trackLength)
+		{
+			result.m_status = TUNING_RUN_LAP_COMPLETE;
+			break;
+		}
+
+		//A couple of meters every few seconds is enough to not count as stuck
+		if (lapProgress > progressAtLastCheck + 2.f)
+		{
+			progressAtLastCheck = lapProgress;
+			timeWithoutProgress = 0.f;
+		}
+		else
+		{
+			timeWithoutProgress += tickTime;
+			if (timeWithoutProgress > profile->m_stuckSeconds)
+			{
+				result.m_status = TUNING_RUN_STUCK;
+				break;
+			}
+		}
+
+		PxVec3 up = pose.q.rotate(PxVec3(0.f, 1.f, 0.f));
+		timeFlipped = (up.y < 0.3f) ? timeFlipped + tickTime : 0.f;
+		if (timeFlipped > profile->m_flippedSeconds)
+		{
+			result.m_status = TUNING_RUN_FLIPPED;
+			break;
+		}
+
+		//Steer at a point ahead on the centerline. Vehicle forward is +Z and a positive steer input turns towards -X
+		Vec3 targetPosition;
+		Vec3 targetTangent;
+		centerline->GetPoseAtDistance(projection.m_trackDistance + profile->m_lookAheadDistance, targetPosition, targetTangent);
+		PxVec3 localTarget = pose.q.rotateInv(PhysXSystem::VecToPxVector(targetPosition) - pose.p);
+		float headingError = atan2f(localTarget.x, localTarget.z);
+		float steer = PxClamp(-profile->m_steerGain * headingError / maxSteer, -1.f, 1.f);
+
+		float forwardSpeed = vehicle->computeForwardSpeed();
+		float targetSpeed = GetTargetSpeed(*centerline, *profile, projection.m_trackDistance);
+		float accel = PxClamp((targetSpeed - forwardSpeed) * profile->m_throttleGain, 0.f, 1.f);
+		float brake = PxClamp((forwardSpeed - targetSpeed) * profile->m_throttleGain, 0.f, 1.f);
+
+		vehicle->mDriveDynData.setAnalogInput(PxVehicleDrive4WControl::eANALOG_INPUT_ACCEL, accel);
+		vehicle->mDriveDynData.setAnalogInput(PxVehicleDrive4WControl::eANALOG_INPUT_BRAKE, brake);
+		vehicle->mDriveDynData.setAnalogInput(PxVehicleDrive4WControl::eANALOG_INPUT_STEER_LEFT, 0.f);
+		vehicle->mDriveDynData.setAnalogInput(PxVehicleDrive4WControl::eANALOG_INPUT_STEER_RIGHT, steer);
+
+		run->m_vehicleManager.UpdateVehicles(tickTime, vehicles, 1);
+		run->m_scene->simulate(tickTime);
+		run->m_scene->fetchResults(true);
+
+		//Stability metrics on the pose after the step
+		pose = vehicleActor->getGlobalPose();
+		PxVec3 forward = pose.q.rotate(PxVec3(0.f, 0.f, 1.f));
+		PxVec3 right = pose.q.rotate(PxVec3(1.f, 0.f, 0.f));
+		up = pose.q.rotate(PxVec3(0.f, 1.f, 0.f));
+
+		float speed = vehicleActor->getLinearVelocity().magnitude();
+		float pitchDegrees = PxAbs(asinf(PxClamp(forward.y, -1.f, 1.f))) * radiansToDegrees;
+		float rollDegrees = PxAbs(asinf(PxClamp(right.y, -1.f, 1.f))) * radiansToDegrees;
+		float yawRate = PxAbs(vehicleActor->getAngularVelocity().dot(up));
+		float lateralOffset = PxAbs(projection.m_lateralOffset);
+
+		result.m_topSpeed = PxMax(result.m_topSpeed, speed);
+		result.m_maxPitchDegrees = PxMax(result.m_maxPitchDegrees, pitchDegrees);
+		result.m_maxRollDegrees = PxMax(result.m_maxRollDegrees, rollDegrees);
+		result.m_maxYawRate = PxMax(result.m_maxYawRate, yawRate);
+		result.m_maxLateralOffset = PxMax(result.m_maxLateralOffset, lateralOffset);
+		lateralOffsetSum += lateralOffset;
+
+		if (PxVehicleIsInAir(run->m_vehicleManager.GetVehicleQueryResult(0)))
+		{
+			result.m_airborneTime += tickTime;
+		}
+	}
+
+	float elapsedTime = (float)tickIndex * tickTime;
+	result.m_lapTime = elapsedTime;
+	result.m_lapProgress = PxClamp(lapProgress / trackLength, 0.f, 1.f);
+	result.m_averageSpeed = (elapsedTime > 0.f) ? PxMax(lapProgress, 0.f) / elapsedTime : 0.f;
+	result.m_meanLateralOffset = (tickIndex > 0) ? lateralOffsetSum / (float)tickIndex : 0.f;
+	result.m_wallSeconds = GetCurrentTimeSeconds() - startTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void TuningEvaluator::LoadInputProfile(const XMLElement& profileElement, TuningInputProfile& outProfile)
+{
+	outProfile.m_tickRate = PxMax(ParseXmlAttribute(profileElement, "tickRate", outProfile.m_tickRate), 30.f);
+	outProfile.m_maxLapSeconds = ParseXmlAttribute(profileElement, "maxLapSeconds", outProfile.m_maxLapSeconds);
+	outProfile.m_startDistance = ParseXmlAttribute(profileElement, "startDistance", outProfile.m_startDistance);
+	outProfile.m_lookAheadDistance = ParseXmlAttribute(profileElement, "lookAheadDistance", outProfile.m_lookAheadDistance);
+	outProfile.m_steerGain = ParseXmlAttribute(profileElement, "steerGain", outProfile.m_steerGain);
+	outProfile.m_brakeLookAheadDistance = ParseXmlAttribute(profileElement, "brakeLookAheadDistance", outProfile.m_brakeLookAheadDistance);
+	outProfile.m_maxLateralAccel = ParseXmlAttribute(profileElement, "maxLateralAccel", outProfile.m_maxLateralAccel);
+	outProfile.m_brakeDecel = ParseXmlAttribute(profileElement, "brakeDecel", outProfile.m_brakeDecel);
+	outProfile.m_maxTargetSpeed = ParseXmlAttribute(profileElement, "maxTargetSpeed", outProfile.m_maxTargetSpeed);
+	outProfile.m_throttleGain = ParseXmlAttribute(profileElement, "throttleGain", outProfile.m_throttleGain);
+	outProfile.m_stuckSeconds = ParseXmlAttribute(profileElement, "stuckSeconds", outProfile.m_stuckSeconds);
+	outProfile.m_flippedSeconds = ParseXmlAttribute(profileElement, "flippedSeconds", outProfile.m_flippedSeconds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC float TuningEvaluator::GetTargetSpeed(const TrackCenterline& centerline, const TuningInputProfile& profile, float trackDistance)
+{
+	const float sampleSpacing = 5.f;
+
+	Vec3 position;
+	Vec3 tangent;
+	centerline.GetPoseAtDistance(trackDistance, position, tangent);
+
+	float targetSpeed = profile.m_maxTargetSpeed;
+	for (float aheadDistance = sampleSpacing; aheadDistance <= profile.m_brakeLookAheadDistance; aheadDistance += sampleSpacing)
+	{
+		Vec3 nextPosition;
+		Vec3 nextTangent;
+		centerline.GetPoseAtDistance(trackDistance + aheadDistance, nextPosition, nextTangent);
+
+		//Curvature is how much the direction turns over the sample spacing
+		float cosTurn = PxClamp(PhysXSystem::VecToPxVector(tangent).dot(PhysXSystem::VecToPxVector(nextTangent)), -1.f, 1.f);
+		float curvature = acosf(cosTurn) / sampleSpacing;
+		if (curvature > 0.0001f)
+		{
+			//Fastest we can go now and still brake down to the corner speed by the time we get there
+			float cornerSpeed = sqrtf(profile.m_maxLateralAccel / curvature);
+			float brakingDistance = aheadDistance - sampleSpacing;
+			float allowedSpeed = sqrtf(cornerSpeed * cornerSpeed + 2.f * profile.m_brakeDecel * brakingDistance);
+			targetSpeed = PxMin(targetSpeed, allowedSpeed);
+		}
+
+		tangent = nextTangent;
+	}
+
+	return targetSpeed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool TuningEvaluator::WriteResultsCSV(const std::string& csvFilePath, const std::vector<TuningResult>& results)
+{
+	std::ofstream* writeStream = CreateFileWriteBuffer(csvFilePath);
+	if (writeStream == nullptr || !writeStream->is_open())
+	{
+		delete writeStream;
+		return false;
+	}
+
+	std::string header = "name,status,lapTime,lapProgress,topSpeed,averageSpeed,maxLateralOffset,meanLateralOffset,maxRollDegrees,maxPitchDegrees,maxYawRate,airborneTime,wallSeconds\n";
+	writeStream->write(header.c_str(), header.length());
+
+	for (const TuningResult& result : results)
+	{
+		std::string line = Stringf("%s,%s,%.3f,%.4f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f,%.3f,%.3f,%.2f\n",
+			QuoteCSVField(result.m_name).c_str(),
+			GetNameForRunStatus(result.m_status),
+			result.m_lapTime,
+			result.m_lapProgress,
+			result.m_topSpeed,
+			result.m_averageSpeed,
+			result.m_maxLateralOffset,
+			result.m_meanLateralOffset,
+			result.m_maxRollDegrees,
+			result.m_maxPitchDegrees,
+			result.m_maxYawRate,
+			result.m_airborneTime,
+			result.m_wallSeconds);
+		writeStream->write(line.c_str(), line.length());
+	}
+
+	writeStream->flush();
+	writeStream->close();
+	delete writeStream;
+	return true;
+}
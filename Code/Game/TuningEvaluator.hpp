@@ -0,0 +1,109 @@
+#pragma once
+//Engine Systems
+#include "Engine/Core/EventSystems.hpp"
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+//Game Systems
+#include "Game/CarTool.hpp"
+#include "Game/TireSurfaceTable.hpp"
+#include "Game/VehicleManager.hpp"
+//Third Party
+#include "extensions/PxDefaultCpuDispatcher.h"
+#include <string>
+#include <vector>
+
+class TrackCenterline;
+struct TuningSweepWork;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eTuningRunStatus
+{
+	TUNING_RUN_LAP_COMPLETE = 0,
+	TUNING_RUN_TIMED_OUT,		//Still driving when the lap time limit ran out
+	TUNING_RUN_STUCK,			//Made no progress along the track for too long, usually pinned on a wall
+	TUNING_RUN_FLIPPED,			//Spent too long on its side or roof
+
+	NUM_TUNING_RUN_STATUSES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The scripted driver every parameter set gets. It chases a point ahead on the centerline and picks a target speed from the
+// curvature coming up, so the only thing that changes between runs is the car
+//------------------------------------------------------------------------------------------------------------------------------
+struct TuningInputProfile
+{
+	float					m_tickRate = 100.f;
+	float					m_maxLapSeconds = 240.f;
+	float					m_startDistance = 0.f;			//Where on the centerline the car starts, the lap is measured from here
+	float					m_lookAheadDistance = 12.f;		//Steering target distance ahead of the car's projection
+	float					m_steerGain = 1.5f;
+	float					m_brakeLookAheadDistance = 60.f;	//How far ahead corners are read for the target speed
+	float					m_maxLateralAccel = 9.f;		//Corner speed is sqrt(maxLateralAccel / curvature)
+	float					m_brakeDecel = 8.f;
+	float					m_maxTargetSpeed = 70.f;
+	float					m_throttleGain = 0.5f;
+	float					m_stuckSeconds = 5.f;
+	float					m_flippedSeconds = 2.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct TuningResult
+{
+	std::string				m_name;
+	eTuningRunStatus		m_status = TUNING_RUN_TIMED_OUT;
+	float					m_lapTime = 0.f;				//Time at the finish, or when the run was stopped
+	float					m_lapProgress = 0.f;			//Fraction of the lap covered
+	float					m_topSpeed = 0.f;
+	float					m_averageSpeed = 0.f;
+	float					m_maxLateralOffset = 0.f;		//Largest distance from the centerline
+	float					m_meanLateralOffset = 0.f;
+	float					m_maxRollDegrees = 0.f;
+	float					m_maxPitchDegrees = 0.f;
+	float					m_maxYawRate = 0.f;				//Radians per second
+	float					m_airborneTime = 0.f;			//Seconds with every wheel off the ground
+	double					m_wallSeconds = 0.0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Everything one parameter set needs to run on its own thread: its own scene, dispatcher, vehicle and vehicle manager
+//------------------------------------------------------------------------------------------------------------------------------
+struct TuningRun
+{
+	CarTool					m_carTool;		//The actor and shapes point at the tool's user data, so the tool lives as long as the car
+	VehicleManager			m_vehicleManager;
+	PxDefaultCpuDispatcher*	m_dispatcher = nullptr;
+	PxScene*				m_scene = nullptr;
+	PxVehicleDrive4W*		m_vehicle = nullptr;
+
+	TuningResult			m_result;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Headless tuning sweep. Reads a file of CarTool parameter sets, drives each one around the ScaledTrack with the scripted
+// input profile in its own PxScene, and writes lap time, top speed and stability metrics to a CSV.
+// Each worker thread takes the next parameter set as soon as its last run finishes, so one slow run never holds up the rest.
+// Cars and scenes are made and released one at a time under the sweep's setup lock because the engine creates vehicles
+// straight into the game scene
+//------------------------------------------------------------------------------------------------------------------------------
+class TuningEvaluator
+{
+public:
+	//numThreads 0 uses every core. Returns false if the sweep file or the track couldn't be loaded
+	static bool				RunSweep(const std::string& sweepFilePath, const std::string& csvFilePath, uint numThreads, std::string& outSummary);
+
+	static void				RegisterConsoleCommands();
+
+	//EvaluateTuning sets=Data/Gameplay/TuningSweep.xml out=Data/Gameplay/TuningResults.csv threads=0
+	static bool				Command_EvaluateTuning(EventArgs& args);
+
+	static const char*		GetNameForRunStatus(eTuningRunStatus status);
+
+private:
+	static TuningRun*		CreateRun(const XMLElement& parameterSet, const TrackCenterline& centerline, const TuningInputProfile& profile, const std::string& bakedTrackPath, const TireSurfaceTable& tireSurfaces, eTireSurface groundSurface);
+	static void				DestroyRun(TuningRun* run);
+	static void				SimulateRun(TuningRun* run, const TrackCenterline* centerline, const TuningInputProfile* profile);
+	static void				RunSweepWorker(TuningSweepWork* work);
+
+	static void				LoadInputProfile(const XMLElement& profileElement, TuningInputProfile& outProfile);
+	static float			GetTargetSpeed(const TrackCenterline& centerline, const TuningInputProfile& profile, float trackDistance);
+	static bool				WriteResultsCSV(const std::string& csvFilePath, const std::vector<TuningResult>& results);
+};
@@ -0,0 +1,287 @@
+#include "Game/VehicleManager.hpp"
+//Engine Systems
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Engine/Core/Time.hpp"
+//PhysX
+#include "ThirdParty/PhysX/include/vehicle/PxVehicleUtil.h"
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleManager::VehicleManager()
+{
+	for (uint chunkIndex = 0; chunkIndex < MAX_VEHICLE_CHUNKS; chunkIndex++)
+	{
+		m_batchQueries[chunkIndex] = nullptr;
+	}
+
+	for (uint vehicleIndex = 0; vehicleIndex < MAX_MANAGED_VEHICLES; vehicleIndex++)
+	{
+		m_vehicles[vehicleIndex] = nullptr;
+		m_vehicleQueryResults[vehicleIndex].wheelQueryResults = &m_wheelQueryResults[vehicleIndex * MAX_WHEELS_PER_MANAGED_VEHICLE];
+		m_vehicleQueryResults[vehicleIndex].nbWheelQueryResults = 0;
+
+		m_vehicleConcurrentUpdates[vehicleIndex].concurrentWheelUpdates = &m_wheelConcurrentUpdates[vehicleIndex * MAX_WHEELS_PER_MANAGED_VEHICLE];
+		m_vehicleConcurrentUpdates[vehicleIndex].nbConcurrentWheelUpdates = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleManager::~VehicleManager()
+{
+	Shutdown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::Startup(int numWorkerThreads)
+{
+	Shutdown();
+
+	CreateSceneQueries();
+
+	if (numWorkerThreads < 0)
+	{
+		uint coreCount = std::thread::hardware_concurrency();
+		numWorkerThreads = (coreCount > 1) ? (int)coreCount - 1 : 0;
+	}
+	SetNumWorkerThreads((uint)numWorkerThreads);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::Shutdown()
+{
+	m_workerPool.Shutdown();
+	DestroySceneQueries();
+
+	m_numVehicles = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetScene(PxScene* scene)
+{
+	m_scene = scene;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetTireFrictionPairs(const PxVehicleDrivableSurfaceToTireFrictionPairs* tireFrictionPairs)
+{
+	m_tireFrictionPairs = tireFrictionPairs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::CreateSceneQueries()
+{
+	if (m_scene == nullptr)
+	{
+		m_scene = g_PxPhysXSystem->GetPhysXScene();
+	}
+
+	//One batch per chunk. Batch queries can't be shared between threads so each chunk gets its own
+	if (m_wheelContactMode == WHEEL_CONTACT_SWEEP)
+	{
+		//Sweeps need every touch reported so the vehicle SDK can pick the best contact per wheel
+		m_sceneQueryData = VehicleSceneQueryData::allocate(MAX_MANAGED_VEHICLES, MAX_WHEELS_PER_MANAGED_VEHICLE, m_numSweepHitsPerWheel, VEHICLES_PER_CHUNK, WheelSceneQueryPreFilterNonBlocking, WheelSceneQueryPostFilterNonBlocking, m_allocator);
+	}
+	else
+	{
+		m_sceneQueryData = VehicleSceneQueryData::allocate(MAX_MANAGED_VEHICLES, MAX_WHEELS_PER_MANAGED_VEHICLE, 1, VEHICLES_PER_CHUNK, WheelSceneQueryPreFilterBlocking, NULL, m_allocator);
+	}
+
+	for (uint chunkIndex = 0; chunkIndex < MAX_VEHICLE_CHUNKS; chunkIndex++)
+	{
+		m_batchQueries[chunkIndex] = VehicleSceneQueryData::setUpBatchedSceneQuery(chunkIndex, *m_sceneQueryData, m_scene);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::DestroySceneQueries()
+{
+	for (uint chunkIndex = 0; chunkIndex < MAX_VEHICLE_CHUNKS; chunkIndex++)
+	{
+		if (m_batchQueries[chunkIndex] != nullptr)
+		{
+			m_batchQueries[chunkIndex]->release();
+			m_batchQueries[chunkIndex] = nullptr;
+		}
+	}
+
+	if (m_sceneQueryData != nullptr)
+	{
+		m_sceneQueryData->free(m_allocator);
+		m_sceneQueryData = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetNumWorkerThreads(uint numWorkerThreads)
+{
+	m_workerPool.Startup(numWorkerThreads);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint VehicleManager::GetNumWorkerThreads() const
+{
+	return m_workerPool.GetNumWorkerThreads();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::SetWheelContactMode(eWheelContactMode contactMode, uint numSweepHitsPerWheel)
+{
+	if (numSweepHitsPerWheel < 1)
+	{
+		numSweepHitsPerWheel = 1;
+	}
+	else if (numSweepHitsPerWheel > MAX_SWEEP_HITS_PER_WHEEL)
+	{
+		numSweepHitsPerWheel = MAX_SWEEP_HITS_PER_WHEEL;
+	}
+
+	if (m_wheelContactMode == contactMode && m_numSweepHitsPerWheel == numSweepHitsPerWheel)
+	{
+		return;
+	}
+
+	m_wheelContactMode = contactMode;
+	m_numSweepHitsPerWheel = numSweepHitsPerWheel;
+
+	//Timing from the old mode would skew the average for the new one
+	m_averageUpdateTimeSeconds = 0.0;
+
+	if (m_sceneQueryData != nullptr)
+	{
+		DestroySceneQueries();
+		CreateSceneQueries();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+eWheelContactMode VehicleManager::GetWheelContactMode() const
+{
+	return m_wheelContactMode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint VehicleManager::GetNumSweepHitsPerWheel() const
+{
+	return m_numSweepHitsPerWheel;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double VehicleManager::GetLastUpdateTimeSeconds() const
+{
+	return m_lastUpdateTimeSeconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double VehicleManager::GetAverageUpdateTimeSeconds() const
+{
+	return m_averageUpdateTimeSeconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::UpdateVehicles(float deltaTime, PxVehicleWheels* const* vehicles, uint numVehicles)
+{
+	if (m_sceneQueryData == nullptr)
+	{
+		return;
+	}
+
+	ASSERT_RECOVERABLE(numVehicles <= MAX_MANAGED_VEHICLES, "Too many vehicles for the vehicle manager");
+	if (numVehicles > MAX_MANAGED_VEHICLES)
+	{
+		numVehicles = MAX_MANAGED_VEHICLES;
+	}
+
+	m_numVehicles = 0;
+	for (uint vehicleIndex = 0; vehicleIndex < numVehicles; vehicleIndex++)
+	{
+		m_vehicles[vehicleIndex] = vehicles[vehicleIndex];
+
+		uint numVehicleWheels = vehicles[vehicleIndex]->mWheelsSimData.getNbWheels();
+		ASSERT_RECOVERABLE(numVehicleWheels <= MAX_WHEELS_PER_MANAGED_VEHICLE, "Vehicle has more wheels than the vehicle manager supports");
+
+		m_vehicleQueryResults[vehicleIndex].nbWheelQueryResults = numVehicleWheels;
+		m_vehicleConcurrentUpdates[vehicleIndex].nbConcurrentWheelUpdates = numVehicleWheels;
+		m_numVehicles++;
+	}
+
+	if (m_numVehicles == 0)
+	{
+		return;
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+
+	uint numChunks = (m_numVehicles + VEHICLES_PER_CHUNK - 1) / VEHICLES_PER_CHUNK;
+
+	m_tickDeltaTime = deltaTime;
+	m_tickGravity = m_scene->getGravity();
+	m_useConcurrentUpdates = (numChunks > 1 && m_workerPool.GetNumWorkerThreads() > 0);
+
+	m_workerPool.RunJobs(numChunks, UpdateVehicleChunkJob, this);
+
+	//Apply the actor writes the chunks deferred, this has to happen on one thread
+	if (m_useConcurrentUpdates)
+	{
+		PxVehiclePostUpdates(m_vehicleConcurrentUpdates, m_numVehicles, m_vehicles);
+	}
+
+	m_lastUpdateTimeSeconds = GetCurrentTimeSeconds() - startTime;
+	if (m_averageUpdateTimeSeconds == 0.0)
+	{
+		m_averageUpdateTimeSeconds = m_lastUpdateTimeSeconds;
+	}
+	else
+	{
+		m_averageUpdateTimeSeconds += (m_lastUpdateTimeSeconds - m_averageUpdateTimeSeconds) * 0.01;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint VehicleManager::GetNumVehicles() const
+{
+	return m_numVehicles;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const PxVehicleWheelQueryResult& VehicleManager::GetVehicleQueryResult(uint vehicleIndex) const
+{
+	return m_vehicleQueryResults[vehicleIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void VehicleManager::UpdateVehicleChunkJob(uint chunkIndex, void* userData)
+{
+	VehicleManager* vehicleManager = reinterpret_cast<VehicleManager*>(userData);
+	vehicleManager->UpdateVehicleChunk(chunkIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleManager::UpdateVehicleChunk(uint chunkIndex)
+{
+	uint firstVehicle = chunkIndex * VEHICLES_PER_CHUNK;
+	uint numChunkVehicles = m_numVehicles - firstVehicle;
+	if (numChunkVehicles > VEHICLES_PER_CHUNK)
+	{
+		numChunkVehicles = VEHICLES_PER_CHUNK;
+	}
+
+	PxVehicleWheels** chunkVehicles = &m_vehicles[firstVehicle];
+
+	//Scene queries for the chunk. Results are written wheel by wheel so each vehicle reads its own slice of the chunk's buffer
+	const PxU32 queryResultsSize = m_sceneQueryData->getQueryResultBufferSize();
+	if (m_wheelContactMode == WHEEL_CONTACT_SWEEP)
+	{
+		//Radius scale slightly over 1 so a wheel resting exactly on a seam still touches both pieces
+		PxSweepQueryResult* sweepResults = m_sceneQueryData->getSweepQueryResultBuffer(chunkIndex);
+		PxVehicleSuspensionSweeps(m_batchQueries[chunkIndex], numChunkVehicles, chunkVehicles, queryResultsSize, sweepResults, m_numSweepHitsPerWheel, NULL, 1.0f, 1.01f);
+	}
+	else
+	{
+		PxRaycastQueryResult* raycastResults = m_sceneQueryData->getRaycastQueryResultBuffer(chunkIndex);
+		PxVehicleSuspensionRaycasts(m_batchQueries[chunkIndex], numChunkVehicles, chunkVehicles, queryResultsSize, raycastResults);
+	}
+
+	//Vehicle update for the chunk, the friction pairs are only read so every chunk can share them
+	const PxVehicleDrivableSurfaceToTireFrictionPairs* tireFrictionPairs = (m_tireFrictionPairs != nullptr) ? m_tireFrictionPairs : g_PxPhysXSystem->GetVehicleTireFrictionPairs();
+	PxVehicleConcurrentUpdateData* concurrentUpdates = m_useConcurrentUpdates ? &m_vehicleConcurrentUpdates[firstVehicle] : NULL;
+	PxVehicleUpdates(m_tickDeltaTime, m_tickGravity, *tireFrictionPairs, numChunkVehicles, chunkVehicles, &m_vehicleQueryResults[firstVehicle], concurrentUpdates);
+}
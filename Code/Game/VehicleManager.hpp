@@ -0,0 +1,103 @@
+#pragma once
+//Engine Systems
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+//Game Systems
+#include "Game/VehicleWorkerPool.hpp"
+//Third Party
+#include "extensions/PxDefaultAllocator.h"
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint MAX_MANAGED_VEHICLES = 128;
+constexpr uint MAX_WHEELS_PER_MANAGED_VEHICLE = 4;
+constexpr uint VEHICLES_PER_CHUNK = 8;
+constexpr uint MAX_VEHICLE_CHUNKS = MAX_MANAGED_VEHICLES / VEHICLES_PER_CHUNK;
+constexpr uint MAX_SWEEP_HITS_PER_WHEEL = 8;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eWheelContactMode
+{
+	WHEEL_CONTACT_RAYCAST,		//One ray per wheel, cheapest but snags on seams between collider pieces
+	WHEEL_CONTACT_SWEEP			//Sweeps the wheel shape and keeps the best of several hits, smooth over seams
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Steps every vehicle in the race with batched suspension raycasts or sweeps and PxVehicleUpdates calls.
+// Vehicles are split into chunks of VEHICLES_PER_CHUNK, each chunk has its own batch query and query results so chunks can
+// run on the worker pool. When chunks run in parallel the actor writes are deferred and applied by PxVehiclePostUpdates
+// on the calling thread. Wheel query results are kept around after the update so the cars can read them back
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleManager
+{
+public:
+	VehicleManager();
+	~VehicleManager();
+
+	//A negative worker count gives one worker per core after the first. Managers that already run on a pool thread of
+	//their own should pass 0
+	void								Startup(int numWorkerThreads = -1);
+	void								Shutdown();
+
+	//Scene the wheel queries run against and gravity comes from. Defaults to the game scene, set it before Startup
+	void								SetScene(PxScene* scene);
+
+	//Surface to tire friction table every vehicle reads, nullptr goes back to the engine's single surface table
+	void								SetTireFrictionPairs(const PxVehicleDrivableSurfaceToTireFrictionPairs* tireFrictionPairs);
+
+	//Defaults to one less than the number of cores since the calling thread works too
+	void								SetNumWorkerThreads(uint numWorkerThreads);
+	uint								GetNumWorkerThreads() const;
+
+	//Changing the mode or hit count re-creates the scene queries
+	void								SetWheelContactMode(eWheelContactMode contactMode, uint numSweepHitsPerWheel);
+	eWheelContactMode					GetWheelContactMode() const;
+	uint								GetNumSweepHitsPerWheel() const;
+
+	//Wall clock time spent in UpdateVehicles, the average is smoothed over roughly the last 100 ticks
+	double								GetLastUpdateTimeSeconds() const;
+	double								GetAverageUpdateTimeSeconds() const;
+
+	//Vehicle i in the array uses result slot i, inputs should already be applied to the vehicles for this tick
+	void								UpdateVehicles(float deltaTime, PxVehicleWheels* const* vehicles, uint numVehicles);
+
+	uint								GetNumVehicles() const;
+	const PxVehicleWheelQueryResult&	GetVehicleQueryResult(uint vehicleIndex) const;
+
+private:
+	void								CreateSceneQueries();
+	void								DestroySceneQueries();
+
+	static void							UpdateVehicleChunkJob(uint chunkIndex, void* userData);
+	void								UpdateVehicleChunk(uint chunkIndex);
+
+private:
+	PxScene*							m_scene = nullptr;
+	const PxVehicleDrivableSurfaceToTireFrictionPairs*	m_tireFrictionPairs = nullptr;
+	PxDefaultAllocator					m_allocator;
+	VehicleSceneQueryData*				m_sceneQueryData = nullptr;
+	PxBatchQuery*						m_batchQueries[MAX_VEHICLE_CHUNKS];
+
+	eWheelContactMode					m_wheelContactMode = WHEEL_CONTACT_RAYCAST;
+	uint								m_numSweepHitsPerWheel = 4;
+
+	VehicleWorkerPool					m_workerPool;
+
+	PxVehicleWheels*					m_vehicles[MAX_MANAGED_VEHICLES];
+	uint								m_numVehicles = 0;
+
+	//Wheel results for vehicle i start at m_wheelQueryResults[i * MAX_WHEELS_PER_MANAGED_VEHICLE]
+	PxWheelQueryResult					m_wheelQueryResults[MAX_MANAGED_VEHICLES * MAX_WHEELS_PER_MANAGED_VEHICLE];
+	PxVehicleWheelQueryResult			m_vehicleQueryResults[MAX_MANAGED_VEHICLES];
+
+	//Deferred actor writes for each vehicle when the chunks run in parallel. Same layout as the wheel query results
+	PxVehicleWheelConcurrentUpdateData	m_wheelConcurrentUpdates[MAX_MANAGED_VEHICLES * MAX_WHEELS_PER_MANAGED_VEHICLE];
+	PxVehicleConcurrentUpdateData		m_vehicleConcurrentUpdates[MAX_MANAGED_VEHICLES];
+
+	//Per tick values read by the chunk jobs
+	float								m_tickDeltaTime = 0.f;
+	PxVec3								m_tickGravity = PxVec3(0.f);
+	bool								m_useConcurrentUpdates = false;
+
+	double								m_lastUpdateTimeSeconds = 0.0;
+	double								m_averageUpdateTimeSeconds = 0.0;
+};
@@ -0,0 +1,138 @@
+#include "Game/VehicleStateSnapshot.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxTransform VehicleStateSnapshot::GetInterpolatedActorPose(float alpha) const
+{
+	return InterpolateTransform(m_previous.m_actorPose, m_current.m_actorPose, alpha);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxTransform VehicleStateSnapshot::GetInterpolatedShapePose(int shapeIndex, float alpha) const
+{
+	if (shapeIndex >= m_previous.m_numShapes)
+	{
+		return m_current.m_shapePoses[shapeIndex];
+	}
+
+	int wheelIndex = m_current.m_shapeWheelIndices[shapeIndex];
+	if (wheelIndex >= 0 && wheelIndex < m_current.m_numWheels)
+	{
+		return GetInterpolatedWheelShapePose(shapeIndex, wheelIndex, alpha);
+	}
+
+	return InterpolateTransform(m_previous.m_shapePoses[shapeIndex], m_current.m_shapePoses[shapeIndex], alpha);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PxTransform VehicleStateSnapshot::GetInterpolatedWheelShapePose(int shapeIndex, int wheelIndex, float alpha) const
+{
+	//PhysX applies the spin last, about the wheel's axle. Take it off both poses, blend the steer and suspension that are
+	//left, then put back the spin angle blended on its own so a fast wheel doesn't take the short way round backwards
+	const PxVec3 wheelAxle(1.f, 0.f, 0.f);
+	float previousSpin = m_current.m_wheelSpinAngles[wheelIndex] - m_current.m_wheelSpinDeltas[wheelIndex];
+
+	PxTransform previousPose = m_previous.m_shapePoses[shapeIndex];
+	previousPose.q = previousPose.q * PxQuat(-previousSpin, wheelAxle);
+	PxTransform currentPose = m_current.m_shapePoses[shapeIndex];
+	currentPose.q = currentPose.q * PxQuat(-m_current.m_wheelSpinAngles[wheelIndex], wheelAxle);
+
+	PxTransform pose = InterpolateTransform(previousPose, currentPose, alpha);
+	float spin = previousSpin + m_current.m_wheelSpinDeltas[wheelIndex] * alpha;
+	pose.q = pose.q * PxQuat(spin, wheelAxle);
+	return pose;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec3 VehicleStateSnapshot::GetInterpolatedPosition(float alpha) const
+{
+	PxTransform pose = GetInterpolatedActorPose(alpha);
+	return PhysXSystem::PxVectorToVec(pose.p);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Vec3 VehicleStateSnapshot::GetInterpolatedForwardBasis(float alpha) const
+{
+	PxMat44 pose = PxMat44(GetInterpolatedActorPose(alpha));
+	PxVec3 pxForward = pose.getBasis(2);
+	return PhysXSystem::PxVectorToVec(pxForward);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC PxTransform VehicleStateSnapshot::InterpolateTransform(const PxTransform& start, const PxTransform& end, float alpha)
+{
+	//Normalized lerp on the rotation is plenty for the angle a car turns in one tick. Flip to take the short way round
+	PxQuat endRotation = end.q;
+	if (start.q.dot(endRotation) < 0.f)
+	{
+		endRotation = -endRotation;
+	}
+
+	PxQuat rotation = start.q * (1.f - alpha) + endRotation * alpha;
+	rotation.normalize();
+
+	PxVec3 position = start.p + (end.p - start.p) * alpha;
+	return PxTransform(position, rotation);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleSnapshotBuffer::VehicleSnapshotBuffer()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleSnapshotBuffer::~VehicleSnapshotBuffer()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleSnapshotBuffer::Publish(const VehicleStateSnapshot* snapshots, uint numCars, double publishTime)
+{
+	if (numCars > MAX_SNAPSHOT_CARS)
+	{
+		numCars = MAX_SNAPSHOT_CARS;
+	}
+
+	std::lock_guard<std::mutex> lock(m_publishLock);
+
+	for (uint carIndex = 0; carIndex < numCars; carIndex++)
+	{
+		m_backSnapshots[carIndex] = snapshots[carIndex];
+	}
+
+	m_numBackCars = numCars;
+	m_backPublishTime = publishTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleSnapshotBuffer::AcquireLatest()
+{
+	std::lock_guard<std::mutex> lock(m_publishLock);
+
+	for (uint carIndex = 0; carIndex < m_numBackCars; carIndex++)
+	{
+		m_frontSnapshots[carIndex] = m_backSnapshots[carIndex];
+	}
+
+	m_numFrontCars = m_numBackCars;
+	m_frontPublishTime = m_backPublishTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint VehicleSnapshotBuffer::GetNumCars() const
+{
+	return m_numFrontCars;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const VehicleStateSnapshot& VehicleSnapshotBuffer::GetSnapshot(uint carIndex) const
+{
+	return m_frontSnapshots[carIndex];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double VehicleSnapshotBuffer::GetPublishTime() const
+{
+	return m_frontPublishTime;
+}
@@ -0,0 +1,116 @@
+#pragma once
+//Engine Systems
+#include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Vec3.hpp"
+//Game Systems
+#include "Game/TireSurfaceTable.hpp"
+#include <mutex>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Chassis plus wheels, matches the most shapes we draw for a car
+constexpr int MAX_INTERPOLATED_SHAPES = 10;
+constexpr uint MAX_SNAPSHOT_CARS = 4;
+constexpr int MAX_SNAPSHOT_WHEELS = 4;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// What one wheel touched on the last vehicle update, copied out of the wheel query results so nothing else has to raycast
+// or ask PhysX again
+//------------------------------------------------------------------------------------------------------------------------------
+struct WheelContactState
+{
+	bool					m_isInContact = false;
+	eTireSurface			m_tireSurface = TIRE_SURFACE_ROAD;
+	PxVec3					m_contactPoint = PxVec3(0.f);		//World space, only meaningful while in contact
+	PxVec3					m_contactNormal = PxVec3(0.f, 1.f, 0.f);
+	float					m_tireFriction = 0.f;				//Friction from the table for this surface and tire type
+	float					m_longitudinalSlip = 0.f;
+	float					m_lateralSlip = 0.f;
+	float					m_suspensionJounce = 0.f;			//Positive is compressed past rest, negative is drooping
+	float					m_suspensionCompression = 0.f;		//0 at full droop, 1 at full compression
+	float					m_suspensionForce = 0.f;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Everything the render, audio and HUD need from one vehicle at the end of a physics tick
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleState
+{
+	PxTransform				m_actorPose = PxTransform(PxIdentity);
+	PxTransform				m_shapePoses[MAX_INTERPOLATED_SHAPES];		//Local to the actor
+	int						m_shapeWheelIndices[MAX_INTERPOLATED_SHAPES];	//-1 for shapes that aren't a wheel
+	int						m_numShapes = 0;
+	int						m_chassisShapeIndex = -1;
+
+	//Wheel spin from the vehicle's dynamics. A wheel can turn further than half a revolution in one tick, so the spin since
+	//the previous tick is worked out from the wheel speed instead of from the two poses
+	float					m_wheelSpinAngles[MAX_SNAPSHOT_WHEELS] = {};
+	float					m_wheelSpinDeltas[MAX_SNAPSHOT_WHEELS] = {};
+
+	float					m_engineRotationSpeed = 0.f;
+	float					m_maxEngineRotationSpeed = 1.f;
+	uint					m_currentGear = 0;
+	uint					m_targetGear = 0;
+	float					m_currentGearRatio = 0.f;		//Includes the final drive ratio
+	float					m_lowerGearRatio = 0.f;
+	float					m_forwardSpeed = 0.f;
+
+	//Same order as the vehicle's wheels, front left, front right, rear left, rear right for a 4W
+	WheelContactState		m_wheels[MAX_SNAPSHOT_WHEELS];
+	int						m_numWheels = 0;
+	bool					m_isInAir = false;					//Every wheel off the ground
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The last two ticks for one vehicle, so a render frame can land anywhere between them
+//------------------------------------------------------------------------------------------------------------------------------
+struct VehicleStateSnapshot
+{
+public:
+	PxTransform				GetInterpolatedActorPose(float alpha) const;
+	PxTransform				GetInterpolatedShapePose(int shapeIndex, float alpha) const;
+	Vec3					GetInterpolatedPosition(float alpha) const;
+	Vec3					GetInterpolatedForwardBasis(float alpha) const;
+
+	static PxTransform		InterpolateTransform(const PxTransform& start, const PxTransform& end, float alpha);
+
+private:
+	PxTransform				GetInterpolatedWheelShapePose(int shapeIndex, int wheelIndex, float alpha) const;
+
+public:
+	VehicleState			m_previous;
+	VehicleState			m_current;
+	bool					m_isValid = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Double buffer between the physics side and the main thread. Physics publishes into the back buffer at the end of every tick,
+// the main thread copies it to the front buffer once at the start of its frame and reads only the front buffer after that.
+// Both copies are short and the only places the lock is taken
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleSnapshotBuffer
+{
+public:
+	VehicleSnapshotBuffer();
+	~VehicleSnapshotBuffer();
+
+	//Physics side
+	void							Publish(const VehicleStateSnapshot* snapshots, uint numCars, double publishTime);
+
+	//Main thread side
+	void							AcquireLatest();
+	uint							GetNumCars() const;
+	const VehicleStateSnapshot&		GetSnapshot(uint carIndex) const;
+	double							GetPublishTime() const;
+
+private:
+	std::mutex						m_publishLock;
+
+	VehicleStateSnapshot			m_backSnapshots[MAX_SNAPSHOT_CARS];
+	uint							m_numBackCars = 0;
+	double							m_backPublishTime = 0.0;
+
+	VehicleStateSnapshot			m_frontSnapshots[MAX_SNAPSHOT_CARS];
+	uint							m_numFrontCars = 0;
+	double							m_frontPublishTime = 0.0;
+};
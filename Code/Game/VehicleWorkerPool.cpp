@@ -0,0 +1,139 @@
+#include "Game/VehicleWorkerPool.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleWorkerPool::VehicleWorkerPool()
+{
+	m_nextJob = 0;
+	m_numJobsRemaining = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+VehicleWorkerPool::~VehicleWorkerPool()
+{
+	Shutdown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleWorkerPool::Startup(uint numWorkerThreads)
+{
+	Shutdown();
+
+	m_isQuitting = false;
+	for (uint threadIndex = 0; threadIndex < numWorkerThreads; threadIndex++)
+	{
+		m_workerThreads.emplace_back(&VehicleWorkerPool::WorkerThreadMain, this);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleWorkerPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_workReady.notify_all();
+
+	for (std::thread& threadHandle : m_workerThreads)
+	{
+		threadHandle.join();
+	}
+
+	m_workerThreads.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint VehicleWorkerPool::GetNumWorkerThreads() const
+{
+	return (uint)m_workerThreads.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleWorkerPool::RunJobs(uint numJobs, VehicleJobFunction jobFunction, void* userData)
+{
+	if (numJobs == 0)
+	{
+		return;
+	}
+
+	//Nothing to share, skip the wake up cost
+	if (m_workerThreads.empty() || numJobs == 1)
+	{
+		for (uint jobIndex = 0; jobIndex < numJobs; jobIndex++)
+		{
+			jobFunction(jobIndex, userData);
+		}
+		return;
+	}
+
+	{
+		//A worker that woke up late for the last batch could still be looking at the old job data
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workDone.wait(lock, [this]() { return m_numActiveWorkers == 0; });
+
+		m_jobFunction = jobFunction;
+		m_jobUserData = userData;
+		m_numJobs = numJobs;
+		m_nextJob = 0;
+		m_numJobsRemaining = numJobs;
+		m_generation++;
+	}
+	m_workReady.notify_all();
+
+	RunAvailableJobs();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_workDone.wait(lock, [this]() { return m_numJobsRemaining == 0; });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleWorkerPool::WorkerThreadMain()
+{
+	uint seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workReady.wait(lock, [this, seenGeneration]() { return m_isQuitting || m_generation != seenGeneration; });
+
+			if (m_isQuitting)
+			{
+				return;
+			}
+
+			seenGeneration = m_generation;
+			m_numActiveWorkers++;
+		}
+
+		RunAvailableJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numActiveWorkers--;
+		}
+		m_workDone.notify_all();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void VehicleWorkerPool::RunAvailableJobs()
+{
+	while (true)
+	{
+		uint jobIndex = m_nextJob.fetch_add(1);
+		if (jobIndex >= m_numJobs)
+		{
+			return;
+		}
+
+		m_jobFunction(jobIndex, m_jobUserData);
+
+		if (m_numJobsRemaining.fetch_sub(1) == 1)
+		{
+			//Take the lock so the notify can't land between the caller checking the count and going to sleep
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_workDone.notify_all();
+		}
+	}
+}
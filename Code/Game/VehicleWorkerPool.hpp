@@ -0,0 +1,52 @@
+#pragma once
+//Engine Systems
+#include "Engine/Commons/EngineCommon.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+typedef void (*VehicleJobFunction)(uint jobIndex, void* userData);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// A small set of persistent worker threads for the vehicle simulation. RunJobs hands out job indices to the workers and
+// the calling thread, and only returns once every job has finished. Threads sleep between ticks instead of being re-created
+//------------------------------------------------------------------------------------------------------------------------------
+class VehicleWorkerPool
+{
+public:
+	VehicleWorkerPool();
+	~VehicleWorkerPool();
+
+	//The calling thread also runs jobs, so 0 worker threads means everything runs on the caller
+	void					Startup(uint numWorkerThreads);
+	void					Shutdown();
+
+	uint					GetNumWorkerThreads() const;
+
+	void					RunJobs(uint numJobs, VehicleJobFunction jobFunction, void* userData);
+
+private:
+	void					WorkerThreadMain();
+	void					RunAvailableJobs();
+
+private:
+	std::vector<std::thread>	m_workerThreads;
+
+	std::mutex					m_mutex;
+	std::condition_variable		m_workReady;
+	std::condition_variable		m_workDone;
+
+	//Everything below is written by RunJobs while holding m_mutex and no worker is active
+	VehicleJobFunction			m_jobFunction = nullptr;
+	void*						m_jobUserData = nullptr;
+	uint						m_numJobs = 0;
+	uint						m_generation = 0;
+	uint						m_numActiveWorkers = 0;
+	bool						m_isQuitting = false;
+
+	std::atomic<uint>			m_nextJob;
+	std::atomic<uint>			m_numJobsRemaining;
+};
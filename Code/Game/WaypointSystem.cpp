@@ -1,12 +1,13 @@
 #include "Game/WaypointSystem.hpp"
 //Engine Systems
 #include "Engine/Math/Vertex_Lit.hpp"   
+#include "Engine/Math/AABB3.hpp"
 #include "Engine/Renderer/CPUMesh.hpp"
 #include "Engine/Renderer/GPUMesh.hpp"
 #include "Engine/Renderer/RenderContext.hpp"
 #include "Engine/Core/DevConsole.hpp"
-#include "Engine/Core/Time.hpp"
 #include "Engine/Core/NamedProperties.hpp"
+#include <math.h>
 
 //------------------------------------------------------------------------------------------------------------------------------
 WaypointSystem::WaypointSystem()
@@ -21,16 +22,69 @@ WaypointSystem::~WaypointSystem()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void WaypointSystem::AddNewWayPoint(const Vec3& waypointPosition, const Vec3& waypointHalfExtents, uint waypointIndex)
+void WaypointSystem::SetTrackGates(const TrackGateTable* trackGates)
 {
-	m_waypointList.emplace_back(waypointPosition, waypointHalfExtents, waypointIndex);
+	m_trackGates = trackGates;
+	ResetLapSplits();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const TrackGateTable* WaypointSystem::GetTrackGates() const
+{
+	return m_trackGates;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint WaypointSystem::GetNumWaypoints() const
+{
+	if (m_trackGates == nullptr)
+	{
+		return 0;
+	}
+
+	return m_trackGates->GetNumGates();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::SetBestSplits(const TrackSplitTable* bestSplits)
+{
+	m_bestSplits = bestSplits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::SetRaceClock(const RaceClock* raceClock)
+{
+	m_raceClock = raceClock;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double WaypointSystem::GetRaceClockTime() const
+{
+	if (m_raceClock == nullptr)
+	{
+		return 0.0;
+	}
+
+	return m_raceClock->GetTime();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const double* WaypointSystem::GetBestLapSplits() const
+{
+	return m_bestLapSplits.data();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint WaypointSystem::GetNumBestLapSplits() const
+{
+	return (uint)m_bestLapSplits.size();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 uint WaypointSystem::GetNextWaypointIndex() const
 {
 	uint nextIndex = m_crossedIndex + 1;
-	if (nextIndex < m_waypointList.size())
+	if (nextIndex < GetNumWaypoints())
 	{
 		return nextIndex;
 	}
@@ -47,10 +101,10 @@ uint WaypointSystem::GetCurrentWaypointIndex() const
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-const Vec3& WaypointSystem::GetNextWaypointPosition() const
+Vec3 WaypointSystem::GetNextWaypointPosition() const
 {
-	int index = GetNextWaypointIndex();
-	return m_waypointList[index].GetWaypointPosition();
+	uint index = GetNextWaypointIndex();
+	return m_trackGates->GetGatePosition(index);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -86,14 +140,65 @@ double WaypointSystem::GetTotalTime() const
 {
 	if (m_lapsCompleted)
 	{
-		return m_timeStamps[m_timeStamps.size() - 1];
+		//The clock stopped when the last lap was stamped
+		return m_accumulatedLapTimes;
 	}
 	else
 	{
-		return GetAccumulatedLapTimes();
+		return m_accumulatedLapTimes + GetCurrentLapTime();
 	}
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+double WaypointSystem::GetCurrentLapTime() const
+{
+	if (m_lapsCompleted)
+	{
+		return 0.0;
+	}
+
+	return GetRaceClockTime() - m_currentLapStartTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double WaypointSystem::GetTrackProgress(const Vec3& carPosition) const
+{
+	uint numWaypoints = GetNumWaypoints();
+	if (numWaypoints == 0)
+	{
+		return 0.0;
+	}
+
+	double raceLength = (double)(m_maxLaps * numWaypoints);
+	if (m_lapsCompleted)
+	{
+		//Anything past the race length is a finished car, the earlier finish gets the larger value
+		return raceLength + 1.0 / (1.0 + m_accumulatedLapTimes);
+	}
+
+	uint gatesCrossedThisLap = (m_crossedIndex == UINT_MAX) ? 0 : m_crossedIndex + 1;
+	uint nextIndex = GetNextWaypointIndex();
+	uint previousIndex = (nextIndex == 0) ? numWaypoints - 1 : nextIndex - 1;
+
+	//Fraction of the way from the previous gate to the next one using straight line distance to the next gate
+	Vec3 nextPosition = m_trackGates->GetGatePosition(nextIndex);
+	Vec3 segment = nextPosition - m_trackGates->GetGatePosition(previousIndex);
+	Vec3 toNext = nextPosition - carPosition;
+
+	float segmentLength = sqrtf(segment.x * segment.x + segment.y * segment.y + segment.z * segment.z);
+	float distanceToNext = sqrtf(toNext.x * toNext.x + toNext.y * toNext.y + toNext.z * toNext.z);
+
+	double segmentFraction = 0.0;
+	if (segmentLength > 0.f)
+	{
+		segmentFraction = 1.0 - (double)(distanceToNext / segmentLength);
+		segmentFraction = (segmentFraction < 0.0) ? 0.0 : segmentFraction;
+		segmentFraction = (segmentFraction > 0.999) ? 0.999 : segmentFraction;
+	}
+
+	return (double)((m_lapIndex - 1) * numWaypoints + gatesCrossedThisLap) + segmentFraction;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 bool WaypointSystem::AreLapsComplete() const
 {
@@ -103,49 +208,121 @@ bool WaypointSystem::AreLapsComplete() const
 //------------------------------------------------------------------------------------------------------------------------------
 void WaypointSystem::Startup()
 {
-	m_startTime = GetCurrentTimeSeconds();
+	m_startTime = GetRaceClockTime();
+	m_currentLapStartTime = m_startTime;
+	m_accumulatedLapTimes = 0.0;
+	m_bestLapTime = 0.0;
+	ResetLapSplits();
+	m_hasSplitDelta = false;
+
+	UpdateTimingSnapshot();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::UpdateTimingSnapshot()
+{
+	m_timingSnapshot.m_totalTime = GetTotalTime();
+	m_timingSnapshot.m_currentLapTime = GetCurrentLapTime();
+	m_timingSnapshot.m_lastLapTime = m_timeStamps.empty() ? 0.0 : m_timeStamps.back();
+	m_timingSnapshot.m_bestLapTime = m_bestLapTime;
+	m_timingSnapshot.m_lapNumber = m_lapIndex;
+	m_timingSnapshot.m_maxLaps = m_maxLaps;
+	m_timingSnapshot.m_lapsCompleted = m_lapsCompleted;
+	m_timingSnapshot.m_nextWaypointIndex = (GetNumWaypoints() > 0) ? GetNextWaypointIndex() : 0;
+	m_timingSnapshot.m_splitDelta = m_splitDelta;
+	m_timingSnapshot.m_splitGateIndex = m_splitGateIndex;
+	m_timingSnapshot.m_hasSplitDelta = m_hasSplitDelta;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+const RaceTimingSnapshot& WaypointSystem::GetTimingSnapshot() const
+{
+	return m_timingSnapshot;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void WaypointSystem::Update(const Vec3& carPosition)
 {
-	if (m_lapsCompleted)
+	if (m_lapsCompleted || GetNumWaypoints() == 0)
 	{
 		//We finished the track. There are no more waypoints
 		return;
 	}
 
-	std::vector<WaypointRegionBased>::iterator waypointItr;
-	waypointItr = m_waypointList.begin();
+	//Only the next waypoint can advance the lap so that is the only one we need to test. Sweeping from the 
+	//last tested position means we can't skip over a gate no matter how fast the car is or how often we check
+	Vec3 sweepStart = BeginGateTest(carPosition);
+	float entryFraction = 1.f;
+	bool crossedNextGate = m_trackGates->HasSegmentCrossedGate(GetNextWaypointIndex(), sweepStart, carPosition, &entryFraction);
+	EndGateTest(carPosition, crossedNextGate, entryFraction);
+}
 
-	while (waypointItr != m_waypointList.end())
+//------------------------------------------------------------------------------------------------------------------------------
+Vec3 WaypointSystem::BeginGateTest(const Vec3& carPosition)
+{
+	if (!m_hasLastTestedPosition)
 	{
-		bool result = waypointItr->HasPointCrossedWaypoint(carPosition);
+		//Nothing to sweep from yet, start the segment at the current position
+		m_lastTestedPosition = carPosition;
+		m_hasLastTestedPosition = true;
+	}
 
-		if (result)
-		{
-			//Check if this is the valid next way point
-			uint wayPointIndex = waypointItr->GetWaypointNumber();
-			if (wayPointIndex == GetNextWaypointIndex())
-			{
-				g_devConsole->PrintString(Rgba::YELLOW, "Reached Next Waypoint");
-				//Call update waypoint and return from here
-				SetSystemToNextWaypoint();
-			}
-		}
+	return m_lastTestedPosition;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::EndGateTest(const Vec3& carPosition, bool crossedNextGate, float entryFraction)
+{
+	if (crossedNextGate)
+	{
+		//The sweep covers the last tick so the entry fraction places the crossing inside that tick
+		double crossingTime = (m_raceClock != nullptr) ? m_raceClock->GetTimeInLastTick(entryFraction) : 0.0;
 
-		waypointItr++;
+		QueueMessage(WAYPOINT_MESSAGE_GATE_REACHED, "Reached Next Waypoint");
+		SetSystemToNextWaypoint(crossingTime);
 	}
 
+	m_lastTestedPosition = carPosition;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::HandleGateCrossing(uint gateIndex, const Vec3& carPosition)
+{
+	if (m_lapsCompleted || gateIndex != GetNextWaypointIndex())
+	{
+		//Driving back through an old gate or skipping ahead doesn't count
+		return;
+	}
+
+	//The trigger only tells us which tick it happened in. Sweep the car center over that tick to find where in the tick it 
+	//entered, if the center never enters the gate (the chassis clipped a corner) we use the end of the tick
+	float entryFraction = 1.f;
+	if (m_hasLastTestedPosition)
+	{
+		m_trackGates->HasSegmentCrossedGate(gateIndex, m_lastTestedPosition, carPosition, &entryFraction);
+	}
+
+	double crossingTime = (m_raceClock != nullptr) ? m_raceClock->GetTimeInLastTick(entryFraction) : 0.0;
+
+	QueueMessage(WAYPOINT_MESSAGE_GATE_REACHED, "Reached Next Waypoint");
+	SetSystemToNextWaypoint(crossingTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::UpdateSweepOrigin(const Vec3& carPosition)
+{
+	m_lastTestedPosition = carPosition;
+	m_hasLastTestedPosition = true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void WaypointSystem::RenderNextWaypoint() const
 {
-	if (m_lapsCompleted)
+	//Gate progress can move on the physics thread, so draw from the snapshot taken in the last update
+	if (m_timingSnapshot.m_lapsCompleted || GetNumWaypoints() == 0)
 		return;
 
-	const WaypointRegionBased* nextWaypoint = &m_waypointList[GetNextWaypointIndex()];
+	uint nextIndex = m_timingSnapshot.m_nextWaypointIndex;
 
 	CPUMesh boxMesh;
 
@@ -153,8 +330,8 @@ void WaypointSystem::RenderNextWaypoint() const
 	CPUMesh postRightMesh;
 	CPUMesh postTopMesh;
 
-	Vec3 mins = nextWaypoint->GetWaypointMins();
-	Vec3 maxs = nextWaypoint->GetWaypointMaxs();
+	Vec3 mins = m_trackGates->GetGateMins(nextIndex);
+	Vec3 maxs = m_trackGates->GetGateMaxs(nextIndex);
 	CPUMeshAddCube(&postLeftMesh, AABB3(mins - Vec3(0.25f, 0.f, 0.25f), mins + Vec3(0.25f, maxs.y * 2.f, 0.25f)), Rgba::ORGANIC_BLUE);
 	CPUMeshAddCube(&postRightMesh, AABB3(Vec3(maxs.x, mins.y, maxs.z) - Vec3(0.25f, 0.f, 0.25f), Vec3(maxs.x, mins.y, maxs.z) + Vec3(0.25f, maxs.y * 2.f, 0.25f)), Rgba::ORGANIC_BLUE);
 
@@ -182,16 +359,14 @@ void WaypointSystem::DebugRenderWaypoints() const
 	CPUMesh boxMesh;
 	GPUMesh mesh = GPUMesh(g_renderContext);
 
-	std::vector<WaypointRegionBased>::const_iterator waypointItr = m_waypointList.begin();
-	while (waypointItr != m_waypointList.end())
+	uint numWaypoints = GetNumWaypoints();
+	for (uint waypointIndex = 0; waypointIndex < numWaypoints; waypointIndex++)
 	{
 		boxMesh.Clear();
 
-		CPUMeshAddCube(&boxMesh, AABB3(waypointItr->GetWaypointMins(), waypointItr->GetWaypointMaxs()), Rgba::GREEN);
+		CPUMeshAddCube(&boxMesh, AABB3(m_trackGates->GetGateMins(waypointIndex), m_trackGates->GetGateMaxs(waypointIndex)), Rgba::GREEN);
 		mesh.CreateFromCPUMesh<Vertex_Lit>(&boxMesh, GPU_MEMORY_USAGE_STATIC);
 		g_renderContext->DrawMesh(&mesh);
-
-		waypointItr++;
 	}
 
 }
@@ -202,7 +377,7 @@ void WaypointSystem::UpdateImGUIForWaypoints()
 	//Create the actual ImGUI widget
 	ImGui::Begin("PhysX Scene Controls");
 
-	ImGui::Text("Number of Waypoints in System : %d", m_waypointList.size());
+	ImGui::Text("Number of Waypoints in System : %d", GetNumWaypoints());
 	ImGui::Text("Max Number of laps allowed for this track: %d", m_maxLaps);
 
 	ImGui::End();
@@ -212,31 +387,83 @@ void WaypointSystem::UpdateImGUIForWaypoints()
 void WaypointSystem::Reset()
 {
 	m_lapsCompleted = false;
-	m_startTime = GetCurrentTimeSeconds();
+	m_startTime = GetRaceClockTime();
+	m_currentLapStartTime = m_startTime;
+	m_accumulatedLapTimes = 0.0;
+	m_bestLapTime = 0.0;
+	ResetLapSplits();
+	m_hasSplitDelta = false;
 	m_timeStamps.clear();
 	m_lapIndex = 1;
 	m_crossedIndex = UINT_MAX;
+	m_hasLastTestedPosition = false;
+	m_queuedMessages.clear();
+
+	UpdateTimingSnapshot();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void WaypointSystem::SetSystemToNextWaypoint()
+void WaypointSystem::QueueMessage(eWaypointMessageType type, const std::string& text)
+{
+	WaypointMessage message;
+	message.m_type = type;
+	message.m_text = text;
+	m_queuedMessages.push_back(message);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::PrintQueuedMessages()
+{
+	for (const WaypointMessage& message : m_queuedMessages)
+	{
+		switch (message.m_type)
+		{
+		case WAYPOINT_MESSAGE_GATE_REACHED:
+			g_devConsole->PrintString(Rgba::YELLOW, message.m_text);
+			break;
+		case WAYPOINT_MESSAGE_LAP_STARTED:
+			g_devConsole->PrintString(Rgba::ORGANIC_PURPLE, message.m_text);
+			break;
+		case WAYPOINT_MESSAGE_LAP_TIME:
+		case WAYPOINT_MESSAGE_RACE_COMPLETED:
+		default:
+			g_devConsole->PrintString(Rgba::GREEN, message.m_text);
+			break;
+		}
+	}
+
+	m_queuedMessages.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::ResetSweepOrigin()
+{
+	//Used when the car is teleported so the jump doesn't get swept through a waypoint
+	m_hasLastTestedPosition = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointSystem::SetSystemToNextWaypoint(double crossingTime)
 {
 	//Increase m_crossedIndex;
 	m_crossedIndex += 1;
 
-	if (m_crossedIndex == m_waypointList.size() - 1)
+	double lapTime = crossingTime - m_currentLapStartTime;
+	RecordSplitForGate(m_crossedIndex, lapTime);
+
+	if (m_crossedIndex == GetNumWaypoints() - 1)
 	{
-		g_devConsole->PrintString(Rgba::ORGANIC_PURPLE, "Entered the next Lap");
-		AddTimeStampForLap();
+		QueueMessage(WAYPOINT_MESSAGE_LAP_STARTED, "Entered the next Lap");
+		AddTimeStampForLap(lapTime);
 		std::string printString = "Time Taken: " + ToString(m_timeStamps[m_timeStamps.size() - 1]);
-		g_devConsole->PrintString(Rgba::GREEN, printString);
+		QueueMessage(WAYPOINT_MESSAGE_LAP_TIME, printString);
 		m_crossedIndex = UINT_MAX;
 		m_lapIndex += 1;
 	}
 
 	if (m_lapIndex > m_maxLaps)
 	{
-		g_devConsole->PrintString(Rgba::GREEN, "Completed Race");
+		QueueMessage(WAYPOINT_MESSAGE_RACE_COMPLETED, "Completed Race");
 
 		m_lapIndex = m_maxLaps; //Get it back to maxLaps just so that our UI doesn't say lap 4 of 3
 		m_lapsCompleted = true;
@@ -244,52 +471,52 @@ void WaypointSystem::SetSystemToNextWaypoint()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void WaypointSystem::AddTimeStampForLap()
+void WaypointSystem::ResetLapSplits()
 {
-	m_timeStamps.push_back(GetLastLapTime());
+	m_currentLapSplits.assign(GetNumWaypoints(), 0.0);
+	m_bestLapSplits.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-double WaypointSystem::GetLastLapTime()
+void WaypointSystem::RecordSplitForGate(uint gateIndex, double lapTime)
 {
-	std::vector<double>::const_iterator timeItr = m_timeStamps.begin();
-	if (timeItr == m_timeStamps.end())
+	if (gateIndex >= (uint)m_currentLapSplits.size())
 	{
-		return GetCurrentTimeSeconds() - m_startTime;
+		ASSERT_RECOVERABLE(false, "Gate crossed past the end of the lap splits, the gate table changed without SetTrackGates");
+		return;
 	}
-	else
-	{
-		double accumulatedTime = 0.0;
 
-		while (timeItr != m_timeStamps.end())
-		{
-			accumulatedTime += *timeItr;
+	m_currentLapSplits[gateIndex] = lapTime;
 
-			timeItr++;
-		}
-		
-		return GetCurrentTimeSeconds() - m_startTime - accumulatedTime;
+	//Constant time compare against the stored best lap for this gate
+	if (m_bestSplits != nullptr && m_bestSplits->HasSplitForGate(gateIndex))
+	{
+		m_splitDelta = lapTime - m_bestSplits->GetSplitForGate(gateIndex);
+		m_splitGateIndex = gateIndex;
+		m_hasSplitDelta = true;
 	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-double WaypointSystem::GetAccumulatedLapTimes() const
+void WaypointSystem::AddTimeStampForLap(double lapTime)
 {
-	std::vector<double>::const_iterator timeItr = m_timeStamps.begin();
-	double accumulatedTime = 0.0;
+	m_timeStamps.push_back(lapTime);
 
-	while (timeItr != m_timeStamps.end())
-	{
-		accumulatedTime += *timeItr;
-
-		timeItr++;
-	}
+	//Keep the running totals up to date so none of the timing queries need to walk the time stamps
+	m_accumulatedLapTimes += lapTime;
+	m_currentLapStartTime += lapTime;
 
-	if (accumulatedTime == 0.0)
+	if (m_bestLapTime == 0.0 || lapTime < m_bestLapTime)
 	{
-		//We didn't get any accumulated time yet
-		accumulatedTime = GetCurrentTimeSeconds() - m_startTime;
+		m_bestLapTime = lapTime;
+
+		//Keep the splits for the best lap of this run so Game can store them if they beat the track's table
+		m_bestLapSplits = m_currentLapSplits;
 	}
+}
 
-	return accumulatedTime;
+//------------------------------------------------------------------------------------------------------------------------------
+double WaypointSystem::GetAccumulatedLapTimes() const
+{
+	return m_accumulatedLapTimes;
 }
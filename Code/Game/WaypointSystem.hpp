@@ -1,10 +1,62 @@
 #pragma once
 //Engine Systems
 #include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Math/Matrix44.hpp"
 //Game Systems
-#include "Game/WaypointRegionBased.hpp"
+#include "Game/TrackGateTable.hpp"
+#include "Game/TrackSplitTable.hpp"
+#include "Game/RaceClock.hpp"
+#include <string>
 #include <vector>
 
+//------------------------------------------------------------------------------------------------------------------------------
+enum eGateDetectionMode
+{
+	GATE_DETECTION_TRIGGERS,	//PhysX trigger events pushed into a queue by WaypointTriggerBased
+	GATE_DETECTION_SWEPT,		//Batched swept segment test against the gate table every update
+
+	//Trigger pairs only report if the engine's vehicle filter shader returns eTRIGGER_DEFAULT for them, which hasn't been
+	//checked against the chassis and gate filter data yet. Until it is the swept test is the one we trust
+	DEFAULT_GATE_DETECTION = GATE_DETECTION_SWEPT
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Race messages are raised on whichever thread steps physics, so they wait here until the main thread prints them
+//------------------------------------------------------------------------------------------------------------------------------
+enum eWaypointMessageType
+{
+	WAYPOINT_MESSAGE_GATE_REACHED,
+	WAYPOINT_MESSAGE_LAP_STARTED,
+	WAYPOINT_MESSAGE_LAP_TIME,
+	WAYPOINT_MESSAGE_RACE_COMPLETED
+};
+
+struct WaypointMessage
+{
+	eWaypointMessageType	m_type = WAYPOINT_MESSAGE_GATE_REACHED;
+	std::string				m_text;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Read-only copy of the race timing, refreshed once per update so the HUD doesn't recompute anything
+//------------------------------------------------------------------------------------------------------------------------------
+struct RaceTimingSnapshot
+{
+	double					m_totalTime = 0.0;
+	double					m_currentLapTime = 0.0;
+	double					m_lastLapTime = 0.0;
+	double					m_bestLapTime = 0.0;
+	uint					m_lapNumber = 1;
+	uint					m_maxLaps = 1;
+	bool					m_lapsCompleted = false;
+	uint					m_nextWaypointIndex = 0;
+
+	//Split at the last gate crossed compared to the best lap split for that gate
+	double					m_splitDelta = 0.0;
+	uint					m_splitGateIndex = 0;
+	bool					m_hasSplitDelta = false;
+};
+
 //------------------------------------------------------------------------------------------------------------------------------
 class WaypointSystem 
 {
@@ -12,10 +64,18 @@ public:
 	WaypointSystem();
 	~WaypointSystem();
 
-	void					AddNewWayPoint(const Vec3& waypointPosition, const Vec3& waypointHalfExtents, uint waypointIndex);
+	void					SetTrackGates(const TrackGateTable* trackGates);
+	const TrackGateTable*	GetTrackGates() const;
+	uint					GetNumWaypoints() const;
+	void					SetBestSplits(const TrackSplitTable* bestSplits);
+	void					SetRaceClock(const RaceClock* raceClock);
+
+	const double*			GetBestLapSplits() const;
+	uint					GetNumBestLapSplits() const;
+
 	uint					GetNextWaypointIndex() const;
 	uint					GetCurrentWaypointIndex() const;
-	const Vec3&				GetNextWaypointPosition() const;
+	Vec3					GetNextWaypointPosition() const;
 	Matrix44				GetNextWaypointModelMatrix() const;
 
 	uint					GetCurrentLapNumber() const;
@@ -23,10 +83,28 @@ public:
 	void					SetMaxLapCount(uint maxLapCount);
 
 	double					GetTotalTime() const;
+	double					GetCurrentLapTime() const;
+
+	//Gates passed over the whole race plus the fraction of the way to the next gate. Finished cars rank by finish time
+	double					GetTrackProgress(const Vec3& carPosition) const;
 	bool					AreLapsComplete() const;
 
+	void					UpdateTimingSnapshot();
+	const RaceTimingSnapshot&	GetTimingSnapshot() const;
+
+	//Main thread only, the dev console isn't safe to write from the physics thread
+	void					PrintQueuedMessages();
+
 	void					Startup();
 	void					Update(const Vec3& carPosition);
+
+	//Split version of Update so Game can test every car in one batch against the shared gate table
+	Vec3					BeginGateTest(const Vec3& carPosition);
+	void					EndGateTest(const Vec3& carPosition, bool crossedNextGate, float entryFraction = 1.f);
+
+	//Used by trigger based detection, only the next gate advances the system. Call UpdateSweepOrigin once all events are handled
+	void					HandleGateCrossing(uint gateIndex, const Vec3& carPosition);
+	void					UpdateSweepOrigin(const Vec3& carPosition);
 	
 	void					RenderNextWaypoint() const;
 	void					DebugRenderWaypoints() const;
@@ -34,17 +112,21 @@ public:
 	void					UpdateImGUIForWaypoints();
 
 	void					Reset();
+	void					ResetSweepOrigin();
 
 private:
-	void					SetSystemToNextWaypoint();
-	void					AddTimeStampForLap();
-	double					GetLastLapTime();
+	void					SetSystemToNextWaypoint(double crossingTime);
+	double					GetRaceClockTime() const;
+	void					ResetLapSplits();
+	void					RecordSplitForGate(uint gateIndex, double lapTime);
+	void					AddTimeStampForLap(double lapTime);
+	void					QueueMessage(eWaypointMessageType type, const std::string& text);
 	double					GetAccumulatedLapTimes() const;
 
-	void					ComputeBestLapTimeForRun();
-
 private:
-	std::vector<WaypointRegionBased> m_waypointList;
+	const TrackGateTable*	m_trackGates = nullptr;		//Owned by Game, shared by every car on the track
+	const TrackSplitTable*	m_bestSplits = nullptr;		//Owned by Game, best lap splits stored for the track
+	const RaceClock*		m_raceClock = nullptr;		//Owned by Game, advanced once per physics tick
 	uint					m_crossedIndex = UINT_MAX;	//This is Uint max. I'm not stupid this was on purpose
 	uint					m_lapIndex = 1;
 	uint					m_maxLaps = 1;
@@ -52,6 +134,24 @@ private:
 	bool					m_lapsCompleted = false;
 
 	double					m_startTime = 0.0;
+	double					m_currentLapStartTime = 0.0;
+	double					m_accumulatedLapTimes = 0.0;	//Running total of m_timeStamps
+	double					m_bestLapTime = 0.0;
+
+	//Car position at the last waypoint check, we sweep from here to the current position
+	Vec3					m_lastTestedPosition = Vec3::ZERO;
+	bool					m_hasLastTestedPosition = false;
 
 	std::vector<double>		m_timeStamps;
+
+	//One split per gate, sized from the gate table so the last split of a lap is always the lap time
+	std::vector<double>		m_currentLapSplits;
+	std::vector<double>		m_bestLapSplits;
+	double					m_splitDelta = 0.0;
+	uint					m_splitGateIndex = 0;
+	bool					m_hasSplitDelta = false;
+
+	RaceTimingSnapshot		m_timingSnapshot;
+
+	std::vector<WaypointMessage>	m_queuedMessages;
 };
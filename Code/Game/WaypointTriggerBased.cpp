@@ -1,13 +1,15 @@
 #include "Game/WaypointTriggerBased.hpp"
 //Engine Systems
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
+#include "Engine/PhysXSystem/PhysXVehicleFilterShader.hpp"
 //Game Systems
-#include "Game/Game.hpp"
+#include "Game/TrackGateTable.hpp"
+#include <algorithm>
 
 //------------------------------------------------------------------------------------------------------------------------------
-WaypointTriggerBased::WaypointTriggerBased(const Game& game)
+static bool IsLookupEntryLess(const ActorLookupEntry& a, const ActorLookupEntry& b)
 {
-	m_game = &game;
+	return a.m_actor < b.m_actor;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -19,27 +21,96 @@ WaypointTriggerBased::WaypointTriggerBased()
 //------------------------------------------------------------------------------------------------------------------------------
 WaypointTriggerBased::~WaypointTriggerBased()
 {
-
+	DestroyTriggers();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void WaypointTriggerBased::SetupWaypoint(const Vec3& waypointPosition, const Vec3& wayPointHalfExtents)
+void WaypointTriggerBased::CreateTriggersForGates(const TrackGateTable& trackGates)
 {
-	//Make a box shaped trigger using the half extents you received
+	DestroyTriggers();
+
 	PxPhysics* PhysX = g_PxPhysXSystem->GetPhysXSDK();
 	PxScene* PhysXScene = g_PxPhysXSystem->GetPhysXScene();
-	PxVec3 pxPosition = g_PxPhysXSystem->VecToPxVector(waypointPosition);
-	PxVec3 pxHalfExtents = g_PxPhysXSystem->VecToPxVector(wayPointHalfExtents);
 
-	m_thisActor = PhysX->createRigidStatic(PxTransform(pxPosition));
-	m_triggerShape = PxRigidActorExt::createExclusiveShape(*m_thisActor, PxBoxGeometry(pxHalfExtents.x * 0.5f, pxHalfExtents.y * 0.5f, pxHalfExtents.z * 0.5f), *g_PxPhysXSystem->GetDefaultPxMaterial());
+	//Only the chassis needs to report against the gates, wheels and obstacles are filtered out
+	PxFilterData simFilterData(COLLISION_FLAG_OBSTACLE, COLLISION_FLAG_CHASSIS, 0, 0);
+
+	uint numGates = trackGates.GetNumGates();
+	for (uint gateIndex = 0; gateIndex < numGates; gateIndex++)
+	{
+		//Make a box shaped trigger the same size as the gate
+		PxVec3 pxPosition = g_PxPhysXSystem->VecToPxVector(trackGates.GetGatePosition(gateIndex));
+		PxVec3 pxHalfExtents = g_PxPhysXSystem->VecToPxVector((trackGates.GetGateMaxs(gateIndex) - trackGates.GetGateMins(gateIndex)) * 0.5f);
+
+		PxRigidStatic* triggerActor = PhysX->createRigidStatic(PxTransform(pxPosition));
+		PxShape* triggerShape = PxRigidActorExt::createExclusiveShape(*triggerActor, PxBoxGeometry(pxHalfExtents), *g_PxPhysXSystem->GetDefaultPxMaterial());
+
+		//Setup the correct trigger shape flags on the PxShape
+		triggerShape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, false);
+		triggerShape->setFlag(PxShapeFlag::eSCENE_QUERY_SHAPE, false);
+		triggerShape->setFlag(PxShapeFlag::eTRIGGER_SHAPE, true);
+		triggerShape->setSimulationFilterData(simFilterData);
+
+		PhysXScene->addActor(*triggerActor);
+		m_triggerActors.push_back(triggerActor);
+
+		ActorLookupEntry entry;
+		entry.m_actor = triggerActor;
+		entry.m_index = gateIndex;
+		m_gateLookup.push_back(entry);
+	}
+
+	SortLookupTable(m_gateLookup);
+
+	//Don't silently knock out whoever was listening before us, their events get passed through
+	m_chainedCallback = PhysXScene->getSimulationEventCallback();
+	m_triggerScene = PhysXScene;
+	PhysXScene->setSimulationEventCallback(this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointTriggerBased::DestroyTriggers()
+{
+	for (PxRigidStatic* triggerActor : m_triggerActors)
+	{
+		triggerActor->release();
+	}
 
-	//Setup the correct trigger shape flags on the PxShape
-	m_thisActor->getShapes(&m_triggerShape, 1);
-	m_triggerShape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, false);
-	m_triggerShape->setFlag(PxShapeFlag::eTRIGGER_SHAPE, true);
+	m_triggerActors.clear();
+	m_gateLookup.clear();
 
-	PhysXScene->addActor(*m_thisActor);
+	if (m_triggerScene != nullptr)
+	{
+		if (m_triggerScene->getSimulationEventCallback() == this)
+		{
+			m_triggerScene->setSimulationEventCallback(m_chainedCallback);
+		}
+
+		m_triggerScene = nullptr;
+		m_chainedCallback = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointTriggerBased::SetCarActors(PxRigidActor* const* carActors, uint numCars)
+{
+	m_carLookup.clear();
+
+	for (uint carIndex = 0; carIndex < numCars; carIndex++)
+	{
+		ActorLookupEntry entry;
+		entry.m_actor = carActors[carIndex];
+		entry.m_index = carIndex;
+		m_carLookup.push_back(entry);
+	}
+
+	SortLookupTable(m_carLookup);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+GateEventQueue& WaypointTriggerBased::GetGateEventQueue()
+{
+	return m_gateEvents;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -51,10 +122,90 @@ void WaypointTriggerBased::onTrigger(PxTriggerPair* pairs, PxU32 count)
 		if (pairs[i].flags & (PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER | PxTriggerPairFlag::eREMOVED_SHAPE_OTHER))
 			continue;
 
-		if ((pairs[i].otherActor == m_game->GetCarActor()) && (pairs[i].triggerActor == m_thisActor))
-		{
-			//Do something since the car entered me
-			DebuggerPrintf("Car hit the trigger");
-		}
+		//We only care about the car entering the gate
+		if (pairs[i].status != PxPairFlag::eNOTIFY_TOUCH_FOUND)
+			continue;
+
+		uint gateIndex = FindIndexForActor(m_gateLookup, pairs[i].triggerActor);
+		uint carIndex = FindIndexForActor(m_carLookup, pairs[i].otherActor);
+		if (gateIndex == UINT_MAX || carIndex == UINT_MAX)
+			continue;
+
+		GateCrossingEvent gateEvent;
+		gateEvent.m_carIndex = carIndex;
+		gateEvent.m_gateIndex = gateIndex;
+		m_gateEvents.Push(gateEvent);
+	}
+
+	//The previous callback still sees every pair, including the gate ones
+	if (m_chainedCallback != nullptr)
+	{
+		m_chainedCallback->onTrigger(pairs, count);
 	}
 }
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointTriggerBased::onConstraintBreak(PxConstraintInfo* constraints, PxU32 count)
+{
+	if (m_chainedCallback != nullptr)
+	{
+		m_chainedCallback->onConstraintBreak(constraints, count);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointTriggerBased::onWake(PxActor** actors, PxU32 count)
+{
+	if (m_chainedCallback != nullptr)
+	{
+		m_chainedCallback->onWake(actors, count);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointTriggerBased::onSleep(PxActor** actors, PxU32 count)
+{
+	if (m_chainedCallback != nullptr)
+	{
+		m_chainedCallback->onSleep(actors, count);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointTriggerBased::onContact(const PxContactPairHeader& pairHeader, const PxContactPair* pairs, PxU32 nbPairs)
+{
+	if (m_chainedCallback != nullptr)
+	{
+		m_chainedCallback->onContact(pairHeader, pairs, nbPairs);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void WaypointTriggerBased::onAdvance(const PxRigidBody*const* bodyBuffer, const PxTransform* poseBuffer, const PxU32 count)
+{
+	if (m_chainedCallback != nullptr)
+	{
+		m_chainedCallback->onAdvance(bodyBuffer, poseBuffer, count);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void WaypointTriggerBased::SortLookupTable(std::vector<ActorLookupEntry>& lookupTable)
+{
+	std::sort(lookupTable.begin(), lookupTable.end(), IsLookupEntryLess);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint WaypointTriggerBased::FindIndexForActor(const std::vector<ActorLookupEntry>& lookupTable, const PxActor* actor)
+{
+	ActorLookupEntry key;
+	key.m_actor = actor;
+
+	std::vector<ActorLookupEntry>::const_iterator entryItr = std::lower_bound(lookupTable.begin(), lookupTable.end(), key, IsLookupEntryLess);
+	if (entryItr != lookupTable.end() && entryItr->m_actor == actor)
+	{
+		return entryItr->m_index;
+	}
+
+	return UINT_MAX;
+}
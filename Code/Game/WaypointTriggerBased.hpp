@@ -4,31 +4,62 @@
 #include "Engine/PhysXSystem/PhysXSystem.hpp"
 #include "Engine/PhysXSystem/PhysXSimulationEventCallbacks.hpp"
 //Game systems
+#include "Game/GateEventQueue.hpp"
+#include <vector>
 
-class Game;
+class TrackGateTable;
 
+//------------------------------------------------------------------------------------------------------------------------------
+struct ActorLookupEntry
+{
+	const PxActor*			m_actor = nullptr;
+	uint					m_index = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Trigger actors for every gate on the track. The PhysX callback turns trigger pairs into gate crossing events
+// using flat lookup tables sorted by actor address, so there is no per frame polling of car positions.
+// If the scene already had a simulation callback it is kept and every event is passed on to it
 //------------------------------------------------------------------------------------------------------------------------------
 class WaypointTriggerBased : public PhysXSimulationEventCallbacks
 {
 public:
 	WaypointTriggerBased();
-	explicit WaypointTriggerBased(const Game& game);
 	~WaypointTriggerBased();
 
-	//Setup the way point 
-	void					SetupWaypoint(const Vec3& waypointPosition, const Vec3& wayPointHalfExtents);
+	//Creates one trigger actor per gate in the table and registers this as the scene's simulation callback
+	void					CreateTriggersForGates(const TrackGateTable& trackGates);
+	//Releases the triggers and puts back the callback that was there before. Has to run before PhysX shuts down
+	void					DestroyTriggers();
+
+	//Has to be called again whenever the car actors are re-created
+	void					SetCarActors(PxRigidActor* const* carActors, uint numCars);
+
+	GateEventQueue&			GetGateEventQueue();
 
 	//////////////////////////////////////////////////////////////////////////
 	//Implement the PhysX simulation callbacks that you need here
 
 	virtual void			onTrigger(PxTriggerPair* pairs, PxU32 count);
 
+	//Only forwarded to the callback we replaced
+	virtual void			onConstraintBreak(PxConstraintInfo* constraints, PxU32 count);
+	virtual void			onWake(PxActor** actors, PxU32 count);
+	virtual void			onSleep(PxActor** actors, PxU32 count);
+	virtual void			onContact(const PxContactPairHeader& pairHeader, const PxContactPair* pairs, PxU32 nbPairs);
+	virtual void			onAdvance(const PxRigidBody*const* bodyBuffer, const PxTransform* poseBuffer, const PxU32 count);
+
 private:
+	static void				SortLookupTable(std::vector<ActorLookupEntry>& lookupTable);
+	static uint				FindIndexForActor(const std::vector<ActorLookupEntry>& lookupTable, const PxActor* actor);
 
-	float					m_timeAtPass = 0.f;
-	PxShape*				m_triggerShape = nullptr;
-	PxRigidStatic*			m_thisActor = nullptr;
+private:
+	std::vector<PxRigidStatic*>		m_triggerActors;
+	PxScene*						m_triggerScene = nullptr;
+	PxSimulationEventCallback*		m_chainedCallback = nullptr;
 
-	const Game*				m_game = nullptr;
+	std::vector<ActorLookupEntry>	m_gateLookup;
+	std::vector<ActorLookupEntry>	m_carLookup;
 
+	GateEventQueue			m_gateEvents;
 };